@@ -0,0 +1,93 @@
+# Copyright 2016-2021 Google Inc.
+# SPDX-License-Identifier: Apache-2.0 OR MIT
+#
+# Builds MinSizeRel static libraries for each feature-stripping configuration
+# and prints the resulting archive sizes.
+#
+# Invoked through the spirv-cross-size-report target, or directly with
+#   cmake -DSOURCE_DIR=<src> -DBINARY_DIR=<dir> [-DGENERATOR=<gen>] -P SizeReport.cmake
+
+cmake_minimum_required(VERSION 3.14)
+
+if (NOT SOURCE_DIR OR NOT BINARY_DIR)
+	message(FATAL_ERROR "SOURCE_DIR and BINARY_DIR must be set.")
+endif()
+
+set(features RAY_TRACING MESH_SHADING TESSELLATION AMD_EXTENSIONS LEGACY_TARGETS SUBGROUP_EMULATION)
+set(libraries core glsl hlsl msl)
+
+set(all-flags "")
+foreach(feature ${features})
+	list(APPEND all-flags -DSPIRV_CROSS_NO_${feature}=ON)
+endforeach()
+
+set(configurations baseline ${features} all webmin)
+
+function(configure_flags config out)
+	if (config STREQUAL "baseline")
+		set(flags "")
+	elseif (config STREQUAL "all")
+		set(flags ${all-flags})
+	elseif (config STREQUAL "webmin")
+		set(flags -DSPIRV_CROSS_ENABLE_WEBMIN=ON)
+	else()
+		set(flags -DSPIRV_CROSS_NO_${config}=ON)
+	endif()
+	set(${out} ${flags} PARENT_SCOPE)
+endfunction()
+
+set(generator-args "")
+if (GENERATOR)
+	set(generator-args -G "${GENERATOR}")
+endif()
+
+set(report "")
+foreach(config ${configurations})
+	configure_flags(${config} flags)
+	set(build-dir ${BINARY_DIR}/${config})
+	message(STATUS "SPIRV-Cross size report: building ${config}.")
+
+	execute_process(
+		COMMAND ${CMAKE_COMMAND} -S ${SOURCE_DIR} -B ${build-dir} ${generator-args}
+			-DCMAKE_BUILD_TYPE=MinSizeRel
+			-DSPIRV_CROSS_CLI=OFF
+			-DSPIRV_CROSS_ENABLE_TESTS=OFF
+			-DSPIRV_CROSS_SHARED=OFF
+			-DSPIRV_CROSS_STATIC=ON
+			${flags}
+		RESULT_VARIABLE result
+		OUTPUT_VARIABLE log
+		ERROR_VARIABLE log)
+	if (NOT result EQUAL 0)
+		message(FATAL_ERROR "Failed to configure ${config}:\n${log}")
+	endif()
+
+	set(targets "")
+	foreach(lib ${libraries})
+		list(APPEND targets --target spirv-cross-${lib})
+	endforeach()
+
+	execute_process(
+		COMMAND ${CMAKE_COMMAND} --build ${build-dir} ${targets}
+		RESULT_VARIABLE result
+		OUTPUT_VARIABLE log
+		ERROR_VARIABLE log)
+	if (NOT result EQUAL 0)
+		message(FATAL_ERROR "Failed to build ${config}:\n${log}")
+	endif()
+
+	set(line "")
+	set(total 0)
+	foreach(lib ${libraries})
+		file(GLOB_RECURSE archive ${build-dir}/*spirv-cross-${lib}.a ${build-dir}/*spirv-cross-${lib}.lib)
+		list(GET archive 0 archive)
+		file(SIZE ${archive} size)
+		math(EXPR total "${total} + ${size}")
+		math(EXPR kib "${size} / 1024")
+		string(APPEND line "  ${lib}=${kib}KiB")
+	endforeach()
+	math(EXPR total-kib "${total} / 1024")
+	string(APPEND report "${config}:${line}  total=${total-kib}KiB\n")
+endforeach()
+
+message("${report}")
@@ -29,18 +29,28 @@
 #include "spirv_parser.hpp"
 #include "spirv_reflect.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstring>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
 #ifdef _WIN32
 #include <io.h>
 #include <fcntl.h>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
 #endif
 
 #ifdef HAVE_SPIRV_CROSS_GIT_VERSION
@@ -279,6 +289,120 @@ static bool write_string_to_file(const char *path, const char *string)
 	return true;
 }
 
+// Creates the directories leading up to a file path. Existing directories are not an error.
+static void create_parent_directories(const string &path)
+{
+	for (size_t pos = path.find_first_of("/\\", 1); pos != string::npos; pos = path.find_first_of("/\\", pos + 1))
+	{
+		string dir = path.substr(0, pos);
+#ifdef _WIN32
+		CreateDirectoryA(dir.c_str(), nullptr);
+#else
+		mkdir(dir.c_str(), 0777);
+#endif
+	}
+}
+
+// An input of a batch compile. dir is the input's directory relative to the --input-dir it was found in,
+// with a trailing slash, or empty for inputs given directly.
+struct BatchInput
+{
+	string path;
+	string dir;
+};
+
+// Appends every non-empty line of a response file as an input path.
+static bool read_response_file(const char *path, SmallVector<BatchInput> &inputs)
+{
+	FILE *file = fopen(path, "r");
+	if (!file)
+	{
+		fprintf(stderr, "Failed to open response file: %s\n", path);
+		return false;
+	}
+
+	string line;
+	int c;
+	do
+	{
+		c = fgetc(file);
+		if (c == '\n' || c == '\r' || c == EOF)
+		{
+			if (!line.empty())
+				inputs.push_back({ line, "" });
+			line.clear();
+		}
+		else
+			line += char(c);
+	} while (c != EOF);
+
+	fclose(file);
+	return true;
+}
+
+// Recursively appends all .spv files below a directory as input paths, in a stable order.
+// relative_dir is the path of dir relative to the directory the walk started in.
+static bool walk_input_directory(const string &dir, const string &relative_dir, SmallVector<BatchInput> &inputs)
+{
+	SmallVector<string> files;
+	SmallVector<string> subdirs;
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA((dir + "\\*").c_str(), &data);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		fprintf(stderr, "Failed to open input directory: %s\n", dir.c_str());
+		return false;
+	}
+
+	do
+	{
+		string name = data.cFileName;
+		if (name == "." || name == "..")
+			continue;
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			subdirs.push_back(name);
+		else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".spv") == 0)
+			files.push_back(name);
+	} while (FindNextFileA(handle, &data));
+	FindClose(handle);
+#else
+	DIR *handle = opendir(dir.c_str());
+	if (!handle)
+	{
+		fprintf(stderr, "Failed to open input directory: %s\n", dir.c_str());
+		return false;
+	}
+
+	while (dirent *entry = readdir(handle))
+	{
+		string name = entry->d_name;
+		if (name == "." || name == "..")
+			continue;
+
+		string path = dir + "/" + name;
+		struct stat st;
+		if (stat(path.c_str(), &st) != 0)
+			continue;
+		if (S_ISDIR(st.st_mode))
+			subdirs.push_back(name);
+		else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".spv") == 0)
+			files.push_back(name);
+	}
+	closedir(handle);
+#endif
+
+	sort(begin(files), end(files));
+	sort(begin(subdirs), end(subdirs));
+	for (auto &file : files)
+		inputs.push_back({ dir + "/" + file, relative_dir });
+	for (auto &subdir : subdirs)
+		if (!walk_input_directory(dir + "/" + subdir, relative_dir + subdir + "/", inputs))
+			return false;
+	return true;
+}
+
 #if defined(__clang__) || defined(__GNUC__)
 #pragma GCC diagnostic pop
 #elif defined(_MSC_VER)
@@ -623,6 +747,9 @@ struct CLIArguments
 {
 	const char *input = nullptr;
 	const char *output = nullptr;
+	SmallVector<BatchInput> inputs;
+	const char *output_template = nullptr;
+	uint32_t jobs = 1;
 	const char *cpp_interface_name = nullptr;
 	uint32_t version = 0;
 	uint32_t shader_model = 0;
@@ -677,11 +804,15 @@ struct CLIArguments
 	bool msl_check_discarded_frag_stores = false;
 	bool msl_sample_dref_lod_array_as_grad = false;
 	bool msl_runtime_array_rich_descriptor = false;
+	bool msl_minimize_packed_struct_members = false;
+	bool msl_packing_report = false;
 	const char *msl_combined_sampler_suffix = nullptr;
 	bool glsl_emit_push_constant_as_ubo = false;
 	bool glsl_emit_ubo_as_plain_uniforms = false;
 	bool glsl_force_flattened_io_blocks = false;
 	uint32_t glsl_ovr_multiview_view_count = 0;
+	bool glsl_infer_relaxed_precision = false;
+	bool glsl_precision_report = false;
 	SmallVector<pair<uint32_t, uint32_t>> glsl_ext_framebuffer_fetch;
 	bool glsl_ext_framebuffer_fetch_noncoherent = false;
 	bool vulkan_glsl_disable_ext_samplerless_texture_functions = false;
@@ -689,6 +820,9 @@ struct CLIArguments
 	bool enable_storage_image_qualifier_deduction = true;
 	bool force_zero_initialized_variables = false;
 	bool relax_nan_checks = false;
+	bool materialize_reused_expressions = false;
+	bool hoist_loop_invariant_loads = false;
+	bool lower_constant_switches = false;
 	uint32_t force_recompile_max_debug_iterations = 3;
 	SmallVector<uint32_t> msl_discrete_descriptor_sets;
 	SmallVector<uint32_t> msl_device_argument_buffers;
@@ -734,6 +868,11 @@ struct CLIArguments
 	bool hlsl_enable_16bit_types = false;
 	bool hlsl_flatten_matrix_vertex_input_semantics = false;
 	bool hlsl_preserve_structured_buffers = false;
+	bool hlsl_coalesce_byte_address_buffer_access = false;
+	bool hlsl_infer_structured_buffers = false;
+	bool hlsl_infer_typed_buffers = false;
+	bool hlsl_elide_stage_io_copies = false;
+	bool hlsl_cache_texture_queries = false;
 	HLSLBindingFlags hlsl_binding_flags = 0;
 	bool vulkan_semantics = false;
 	bool flatten_multidimensional_arrays = false;
@@ -810,6 +949,9 @@ static void print_help_glsl()
 	                "\t\tPrimary use case is supporting external samplers in ESSL for video rendering on Android where you could remap a texture to a YUV one.\n"
 	                "\t[--glsl-force-flattened-io-blocks]:\n\t\tAlways flatten I/O blocks and structs.\n"
 	                "\t[--glsl-ovr-multiview-view-count count]:\n\t\tIn GL_OVR_multiview2, specify layout(num_views).\n"
+	                "\t[--glsl-infer-relaxed-precision]:\n\t\tIn ES and Vulkan GLSL, infer mediump for the whole module up front, "
+	                "avoiding copies between highp and mediump temporaries.\n"
+	                "\t[--glsl-precision-report]:\n\t\tPrint how many operations ended up in mediump and highp to stderr.\n"
 	);
 	// clang-format on
 }
@@ -842,6 +984,14 @@ static void print_help_hlsl()
 	                "\t[--hlsl-enable-16bit-types]:\n\t\tEnables native use of half/int16_t/uint16_t and ByteAddressBuffer interaction with these types. Requires SM 6.2.\n"
 	                "\t[--hlsl-flatten-matrix-vertex-input-semantics]:\n\t\tEmits matrix vertex inputs with input semantics as if they were independent vectors, e.g. TEXCOORD{2,3,4} rather than matrix form TEXCOORD2_{0,1,2}.\n"
 	                "\t[--hlsl-preserve-structured-buffers]:\n\t\tEmit SturucturedBuffer<T> rather than ByteAddressBuffer. Requires UserTypeGOOGLE to be emitted. Intended for DXC roundtrips.\n"
+	                "\t[--hlsl-coalesce-byte-address-buffer-access]:\n\t\tMerge contiguous words of struct, array and row-major matrix ByteAddressBuffer accesses into wide Load/Store operations.\n"
+	                "\t\tOnly applies before SM 6.2.\n"
+	                "\t[--hlsl-infer-structured-buffers]:\n\t\tEmit StructuredBuffer<T> rather than ByteAddressBuffer for SSBOs which only contain a tightly packed runtime array.\n"
+	                "\t[--hlsl-infer-typed-buffers]:\n\t\tEmit Buffer<float4> rather than ByteAddressBuffer for read-only SSBOs which only contain a runtime array of 4-component 32-bit vectors.\n"
+	                "\t[--hlsl-elide-stage-io-copies]:\n\t\tAccess vertex and fragment inputs and outputs through SPIRV_Cross_Input and SPIRV_Cross_Output directly\n"
+	                "\t\trather than copying them through static globals, when only the entry point function uses them.\n"
+	                "\t[--hlsl-cache-texture-queries]:\n\t\tQuery the dimensions of each texture once at the start of a function with GetDimensions()\n"
+	                "\t\trather than calling helper functions at every size, level or sample count query.\n"
 	);
 	// clang-format on
 }
@@ -956,6 +1106,9 @@ static void print_help_msl()
 	                "\t\tSome Metal devices have a bug where the level() argument to\n"
 	                "\t\tdepth2d_array<T>::sample_compare() in a fragment shader is biased by some\n"
 	                "\t\tunknown amount. This prevents the bias from being added.\n"
+	                "\t[--msl-minimize-packed-struct-members]:\n\t\tWhen a struct does not fit its offset or array stride, only pack\n"
+	                "\t\tthe members needed to make it fit rather than every member.\n"
+	                "\t[--msl-packing-report]:\n\t\tPrint how many packed-to-native unpack conversions were emitted to stderr.\n"
 	                "\t[--msl-combined-sampler-suffix <suffix>]:\n\t\tUses a custom suffix for combined samplers.\n");
 	// clang-format on
 }
@@ -984,6 +1137,12 @@ static void print_help_common()
 	                "\t\tIf a stage output variable with matching builtin is active, "
 	                "optimize away the variable if it can affect cross-stage linking correctness.\n"
 	                "\t[--relax-nan-checks]:\n\t\tRelax NaN checks for N{Clamp,Min,Max} and ordered vs. unordered compare instructions.\n"
+	                "\t[--materialize-reused-expressions]:\n\t\tDecide up front which expressions to bind to temporaries "
+	                "based on how often they are read and how expensive they are.\n"
+	                "\t[--hoist-loop-invariant-loads]:\n\t\tMove loads from uniform and read-only buffers "
+	                "which do not change between iterations out of loops.\n"
+	                "\t[--lower-constant-switches]:\n\t\tEmit switches which only select constants "
+	                "as a lookup table or ternary selects.\n"
 	);
 	// clang-format on
 }
@@ -1016,8 +1175,20 @@ static void print_help()
 	                "\nBasic:\n"
 	                "\t[SPIR-V file] (- is stdin)\n"
 	                "\t[--output <output path>]: If not provided, prints output to stdout.\n"
+	                "\t[SPIR-V file...] [@response file] [--input-dir <dir>]:\n\t\tCompiles many inputs in one invocation with the same options.\n"
+	                "\t\tResponse files list one input path per line. --input-dir adds all .spv files below a directory.\n"
+	                "\t[--output-template <template>]:\n\t\tOutput path for each input when compiling many inputs.\n"
+	                "\t\t{name} is replaced with the input file name and {stem} with the file name without its extension.\n"
+	                "\t\t{dir} is replaced with the input's subdirectory below --input-dir, with a trailing slash, or nothing,\n"
+	                "\t\tand {relpath} with {dir}{name}. Missing output directories are created.\n"
+	                "\t[-j <jobs>]:\n\t\tCompiles that many inputs concurrently. Failed inputs are listed and make the exit code non-zero.\n"
 	                "\t[--dump-resources]:\n\t\tPrints a basic reflection of the SPIR-V module along with other output.\n"
 	                "\t[--help]:\n\t\tPrints this help message.\n"
+	                "\t[--server]:\n\t\tMust be the only argument. Serves compile requests over stdin/stdout until stdin is closed.\n"
+	                "\t\tA request is a u32 argument count, each argument as a u32 byte length followed by the bytes,\n"
+	                "\t\tthen a u32 byte length followed by SPIR-V which is used when the input file is \"-\".\n"
+	                "\t\tThe reply is a u32 exit code, then a u32 byte length followed by what would have been printed to stdout.\n"
+	                "\t\tAll integers are in native byte order.\n"
 	);
 	// clang-format on
 
@@ -1233,6 +1404,7 @@ static string compile_iteration(const CLIArguments &args, std::vector<uint32_t>
 		msl_opts.sample_dref_lod_array_as_grad = args.msl_sample_dref_lod_array_as_grad;
 		msl_opts.ios_support_base_vertex_instance = true;
 		msl_opts.runtime_array_rich_descriptor = args.msl_runtime_array_rich_descriptor;
+		msl_opts.minimize_packed_struct_members = args.msl_minimize_packed_struct_members;
 		msl_comp->set_msl_options(msl_opts);
 		for (auto &v : args.msl_discrete_descriptor_sets)
 			msl_comp->add_discrete_descriptor_set(v);
@@ -1378,10 +1550,14 @@ static string compile_iteration(const CLIArguments &args, std::vector<uint32_t>
 	opts.emit_uniform_buffer_as_plain_uniforms = args.glsl_emit_ubo_as_plain_uniforms;
 	opts.force_flattened_io_blocks = args.glsl_force_flattened_io_blocks;
 	opts.ovr_multiview_view_count = args.glsl_ovr_multiview_view_count;
+	opts.infer_relaxed_precision = args.glsl_infer_relaxed_precision;
 	opts.emit_line_directives = args.emit_line_directives;
 	opts.enable_storage_image_qualifier_deduction = args.enable_storage_image_qualifier_deduction;
 	opts.force_zero_initialized_variables = args.force_zero_initialized_variables;
 	opts.relax_nan_checks = args.relax_nan_checks;
+	opts.materialize_reused_expressions = args.materialize_reused_expressions;
+	opts.hoist_loop_invariant_loads = args.hoist_loop_invariant_loads;
+	opts.lower_constant_switches = args.lower_constant_switches;
 	opts.force_recompile_max_debug_iterations = args.force_recompile_max_debug_iterations;
 	compiler->set_common_options(opts);
 
@@ -1427,6 +1603,11 @@ static string compile_iteration(const CLIArguments &args, std::vector<uint32_t>
 		hlsl_opts.enable_16bit_types = args.hlsl_enable_16bit_types;
 		hlsl_opts.flatten_matrix_vertex_input_semantics = args.hlsl_flatten_matrix_vertex_input_semantics;
 		hlsl_opts.preserve_structured_buffers = args.hlsl_preserve_structured_buffers;
+		hlsl_opts.coalesce_byte_address_buffer_access = args.hlsl_coalesce_byte_address_buffer_access;
+		hlsl_opts.infer_structured_buffers = args.hlsl_infer_structured_buffers;
+		hlsl_opts.infer_typed_buffers = args.hlsl_infer_typed_buffers;
+		hlsl_opts.elide_stage_io_copies = args.hlsl_elide_stage_io_copies;
+		hlsl_opts.cache_texture_queries = args.hlsl_cache_texture_queries;
 		hlsl->set_hlsl_options(hlsl_opts);
 		hlsl->set_resource_binding_flags(args.hlsl_binding_flags);
 		if (args.hlsl_base_vertex_index_explicit_binding)
@@ -1542,6 +1723,22 @@ static string compile_iteration(const CLIArguments &args, std::vector<uint32_t>
 
 	auto ret = compiler->compile();
 
+	if (args.glsl_precision_report && !args.msl && !args.hlsl)
+	{
+		auto report = compiler->get_precision_report();
+		fprintf(stderr,
+		        "Precision: %u mediump operations, %u highp operations, %u precision copies, "
+		        "%u inferred mediump values.\n",
+		        report.mediump_operations, report.highp_operations, report.precision_copies,
+		        report.inferred_mediump_values);
+	}
+
+	if (args.msl_packing_report && args.msl)
+	{
+		fprintf(stderr, "Packing: %u unpack conversions.\n",
+		        static_cast<CompilerMSL *>(compiler.get())->get_unpack_conversion_count());
+	}
+
 	if (args.dump_resources)
 	{
 		compiler->update_active_builtins();
@@ -1554,7 +1751,156 @@ static string compile_iteration(const CLIArguments &args, std::vector<uint32_t>
 	return ret;
 }
 
-static int main_inner(int argc, char *argv[])
+static string compile_spirv(const CLIArguments &args, vector<uint32_t> spirv_file)
+{
+	// Special case reflection because it has little to do with the path followed by code-outputting compilers
+	if (!args.reflect.empty())
+	{
+		Parser spirv_parser(std::move(spirv_file));
+		spirv_parser.parse();
+
+		CompilerReflection compiler(std::move(spirv_parser.get_parsed_ir()));
+		compiler.set_format(args.reflect);
+		return compiler.compile();
+	}
+
+	if (args.iterations == 1)
+		return compile_iteration(args, std::move(spirv_file));
+
+	string compiled_output;
+	for (unsigned i = 0; i < args.iterations; i++)
+		compiled_output = compile_iteration(args, spirv_file);
+	return compiled_output;
+}
+
+static void replace_all(string &str, const string &from, const string &to)
+{
+	for (size_t pos = str.find(from); pos != string::npos; pos = str.find(from, pos + to.size()))
+		str.replace(pos, from.size(), to);
+}
+
+static string batch_output_path(const char *output_template, const BatchInput &input)
+{
+	auto slash = input.path.find_last_of("/\\");
+	string name = slash == string::npos ? input.path : input.path.substr(slash + 1);
+	auto dot = name.find_last_of('.');
+	string stem = dot == string::npos ? name : name.substr(0, dot);
+
+	string path = output_template;
+	replace_all(path, "{name}", name);
+	replace_all(path, "{stem}", stem);
+	replace_all(path, "{dir}", input.dir);
+	replace_all(path, "{relpath}", input.dir + name);
+	return path;
+}
+
+// Compiles one input of a batch. Errors are reported per input rather than ending the whole batch.
+static bool compile_batch_input(const CLIArguments &args, const string &input, const string &output_path)
+{
+	auto spirv_file = read_spirv_file(input.c_str());
+	if (spirv_file.empty())
+	{
+		fprintf(stderr, "%s: Failed to read SPIR-V.\n", input.c_str());
+		return false;
+	}
+
+	string compiled_output;
+#ifdef SPIRV_CROSS_EXCEPTIONS_TO_ASSERTIONS
+	compiled_output = compile_spirv(args, std::move(spirv_file));
+#else
+	try
+	{
+		compiled_output = compile_spirv(args, std::move(spirv_file));
+	}
+	catch (const std::exception &e)
+	{
+		fprintf(stderr, "%s: SPIRV-Cross threw an exception: %s\n", input.c_str(), e.what());
+		return false;
+	}
+#endif
+
+	create_parent_directories(output_path);
+	return write_string_to_file(output_path.c_str(), compiled_output.c_str());
+}
+
+static int run_batch(const CLIArguments &args)
+{
+	if (!args.output_template)
+	{
+		fprintf(stderr, "Compiling multiple inputs requires --output-template.\n");
+		return EXIT_FAILURE;
+	}
+
+	if (args.output)
+	{
+		fprintf(stderr, "--output cannot be used with multiple inputs, use --output-template.\n");
+		return EXIT_FAILURE;
+	}
+
+	// Inputs from different subdirectories can expand to the same path, which would silently overwrite outputs.
+	SmallVector<string> output_paths;
+	unordered_map<string, size_t> output_path_to_input;
+	for (size_t i = 0; i < args.inputs.size(); i++)
+	{
+		output_paths.push_back(batch_output_path(args.output_template, args.inputs[i]));
+		auto itr = output_path_to_input.find(output_paths.back());
+		if (itr != end(output_path_to_input))
+		{
+			fprintf(stderr, "Inputs %s and %s would both be written to %s, use {dir} or {relpath} in --output-template.\n",
+			        args.inputs[itr->second].path.c_str(), args.inputs[i].path.c_str(), output_paths.back().c_str());
+			return EXIT_FAILURE;
+		}
+		output_path_to_input[output_paths.back()] = i;
+	}
+
+	vector<uint8_t> failed(args.inputs.size());
+	atomic<size_t> next_input(0);
+
+	auto worker = [&]() {
+		size_t index;
+		while ((index = next_input++) < args.inputs.size())
+			failed[index] = !compile_batch_input(args, args.inputs[index].path, output_paths[index]);
+	};
+
+	uint32_t thread_count = min(args.jobs, uint32_t(args.inputs.size()));
+	vector<thread> threads;
+	for (uint32_t i = 1; i < thread_count; i++)
+		threads.emplace_back(worker);
+	worker();
+	for (auto &t : threads)
+		t.join();
+
+	size_t failure_count = size_t(count(begin(failed), end(failed), uint8_t(1)));
+	if (failure_count)
+	{
+		fprintf(stderr, "%u of %u inputs failed:\n", unsigned(failure_count), unsigned(args.inputs.size()));
+		for (size_t i = 0; i < failed.size(); i++)
+			if (failed[i])
+				fprintf(stderr, "\t%s\n", args.inputs[i].path.c_str());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+// In --server mode, SPIR-V read from stdin and output printed to stdout go through the request instead.
+struct ServerRequest
+{
+	vector<uint32_t> spirv;
+	string output;
+};
+
+static void print_output(const CLIArguments &args, const string &output, ServerRequest *request)
+{
+	if (args.output)
+		write_string_to_file(args.output, output.c_str());
+	else if (request)
+		request->output += output;
+	else
+		printf("%s", output.c_str());
+}
+
+static int main_inner(int argc, char *argv[], ServerRequest *request)
 {
 	CLIArguments args;
 	CLICallbacks cbs;
@@ -1594,6 +1940,8 @@ static int main_inner(int argc, char *argv[])
 	cbs.add("--glsl-emit-ubo-as-plain-uniforms", [&args](CLIParser &) { args.glsl_emit_ubo_as_plain_uniforms = true; });
 	cbs.add("--glsl-force-flattened-io-blocks", [&args](CLIParser &) { args.glsl_force_flattened_io_blocks = true; });
 	cbs.add("--glsl-ovr-multiview-view-count", [&args](CLIParser &parser) { args.glsl_ovr_multiview_view_count = parser.next_uint(); });
+	cbs.add("--glsl-infer-relaxed-precision", [&args](CLIParser &) { args.glsl_infer_relaxed_precision = true; });
+	cbs.add("--glsl-precision-report", [&args](CLIParser &) { args.glsl_precision_report = true; });
 	cbs.add("--glsl-remap-ext-framebuffer-fetch", [&args](CLIParser &parser) {
 		uint32_t input_index = parser.next_uint();
 		uint32_t color_attachment = parser.next_uint();
@@ -1629,6 +1977,12 @@ static int main_inner(int argc, char *argv[])
 	cbs.add("--hlsl-flatten-matrix-vertex-input-semantics",
 	        [&args](CLIParser &) { args.hlsl_flatten_matrix_vertex_input_semantics = true; });
 	cbs.add("--hlsl-preserve-structured-buffers", [&args](CLIParser &) { args.hlsl_preserve_structured_buffers = true; });
+	cbs.add("--hlsl-coalesce-byte-address-buffer-access",
+	        [&args](CLIParser &) { args.hlsl_coalesce_byte_address_buffer_access = true; });
+	cbs.add("--hlsl-infer-structured-buffers", [&args](CLIParser &) { args.hlsl_infer_structured_buffers = true; });
+	cbs.add("--hlsl-infer-typed-buffers", [&args](CLIParser &) { args.hlsl_infer_typed_buffers = true; });
+	cbs.add("--hlsl-elide-stage-io-copies", [&args](CLIParser &) { args.hlsl_elide_stage_io_copies = true; });
+	cbs.add("--hlsl-cache-texture-queries", [&args](CLIParser &) { args.hlsl_cache_texture_queries = true; });
 	cbs.add("--vulkan-semantics", [&args](CLIParser &) { args.vulkan_semantics = true; });
 	cbs.add("-V", [&args](CLIParser &) { args.vulkan_semantics = true; });
 	cbs.add("--flatten-multidimensional-arrays", [&args](CLIParser &) { args.flatten_multidimensional_arrays = true; });
@@ -1792,6 +2146,9 @@ static int main_inner(int argc, char *argv[])
 	});
 	cbs.add("--msl-runtime-array-rich-descriptor",
 	        [&args](CLIParser &) { args.msl_runtime_array_rich_descriptor = true; });
+	cbs.add("--msl-minimize-packed-struct-members",
+	        [&args](CLIParser &) { args.msl_minimize_packed_struct_members = true; });
+	cbs.add("--msl-packing-report", [&args](CLIParser &) { args.msl_packing_report = true; });
 	cbs.add("--extension", [&args](CLIParser &parser) { args.extensions.push_back(parser.next_string()); });
 	cbs.add("--rename-entry-point", [&args](CLIParser &parser) {
 		auto old_name = parser.next_string();
@@ -1897,9 +2254,27 @@ static int main_inner(int argc, char *argv[])
 	});
 
 	cbs.add("--relax-nan-checks", [&](CLIParser &) { args.relax_nan_checks = true; });
+	cbs.add("--materialize-reused-expressions", [&](CLIParser &) { args.materialize_reused_expressions = true; });
+	cbs.add("--hoist-loop-invariant-loads", [&](CLIParser &) { args.hoist_loop_invariant_loads = true; });
+	cbs.add("--lower-constant-switches", [&](CLIParser &) { args.lower_constant_switches = true; });
 
-	cbs.default_handler = [&args](const char *value) { args.input = value; };
-	cbs.add("-", [&args](CLIParser &) { args.input = "-"; });
+	cbs.add("--input-dir", [&args](CLIParser &parser) {
+		if (!walk_input_directory(parser.next_string(), "", args.inputs))
+			THROW("Failed to walk input directory.");
+	});
+	cbs.add("--output-template", [&args](CLIParser &parser) { args.output_template = parser.next_string(); });
+	cbs.add("-j", [&args](CLIParser &parser) { args.jobs = max(parser.next_uint(), 1u); });
+
+	cbs.default_handler = [&args](const char *value) {
+		if (value[0] == '@')
+		{
+			if (!read_response_file(value + 1, args.inputs))
+				THROW("Failed to read response file.");
+		}
+		else
+			args.inputs.push_back({ value, "" });
+	};
+	cbs.add("-", [&args](CLIParser &) { args.inputs.push_back({ "-", "" }); });
 	cbs.error_handler = [] { print_help(); };
 
 	CLIParser parser{ std::move(cbs), argc - 1, argv + 1 };
@@ -1908,60 +2283,40 @@ static int main_inner(int argc, char *argv[])
 	else if (parser.ended_state)
 		return EXIT_SUCCESS;
 
-	if (!args.input)
+	if (args.inputs.empty())
 	{
 		fprintf(stderr, "Didn't specify input file.\n");
 		print_help();
 		return EXIT_FAILURE;
 	}
 
-	auto spirv_file = read_spirv_file(args.input);
-	if (spirv_file.empty())
-		return EXIT_FAILURE;
-
-	// Special case reflection because it has little to do with the path followed by code-outputting compilers
-	if (!args.reflect.empty())
-	{
-		Parser spirv_parser(std::move(spirv_file));
-		spirv_parser.parse();
-
-		CompilerReflection compiler(std::move(spirv_parser.get_parsed_ir()));
-		compiler.set_format(args.reflect);
-		auto json = compiler.compile();
-		if (args.output)
-			write_string_to_file(args.output, json.c_str());
-		else
-			printf("%s", json.c_str());
-		return EXIT_SUCCESS;
-	}
+	if (args.inputs.size() > 1 || args.output_template)
+		return run_batch(args);
 
-	string compiled_output;
+	args.input = args.inputs.front().path.c_str();
 
-	if (args.iterations == 1)
-		compiled_output = compile_iteration(args, std::move(spirv_file));
+	vector<uint32_t> spirv_file;
+	if (request && strcmp(args.input, "-") == 0)
+		spirv_file = std::move(request->spirv);
 	else
-	{
-		for (unsigned i = 0; i < args.iterations; i++)
-			compiled_output = compile_iteration(args, spirv_file);
-	}
+		spirv_file = read_spirv_file(args.input);
 
-	if (args.output)
-		write_string_to_file(args.output, compiled_output.c_str());
-	else
-		printf("%s", compiled_output.c_str());
+	if (spirv_file.empty())
+		return EXIT_FAILURE;
 
+	print_output(args, compile_spirv(args, std::move(spirv_file)), request);
 	return EXIT_SUCCESS;
 }
 
-int main(int argc, char *argv[])
+static int main_protected(int argc, char *argv[], ServerRequest *request)
 {
 #ifdef SPIRV_CROSS_EXCEPTIONS_TO_ASSERTIONS
-	return main_inner(argc, argv);
+	return main_inner(argc, argv, request);
 #else
 	// Make sure we catch the exception or it just disappears into the aether on Windows.
 	try
 	{
-		return main_inner(argc, argv);
+		return main_inner(argc, argv, request);
 	}
 	catch (const std::exception &e)
 	{
@@ -1970,3 +2325,76 @@ int main(int argc, char *argv[])
 	}
 #endif
 }
+
+static bool read_server_data(void *data, size_t size)
+{
+	return fread(data, 1, size, stdin) == size;
+}
+
+static bool read_server_u32(uint32_t &value)
+{
+	return read_server_data(&value, sizeof(value));
+}
+
+static bool write_server_data(const void *data, size_t size)
+{
+	return fwrite(data, 1, size, stdout) == size;
+}
+
+// Serves requests until stdin is closed, so drivers like test_shaders.py
+// avoid paying for process startup once per shader.
+static int run_server()
+{
+#ifdef _WIN32
+	setmode(fileno(stdin), O_BINARY);
+	setmode(fileno(stdout), O_BINARY);
+#endif
+
+	uint32_t arg_count;
+	while (read_server_u32(arg_count))
+	{
+		vector<string> arg_strings(arg_count);
+		for (auto &arg : arg_strings)
+		{
+			uint32_t len;
+			if (!read_server_u32(len))
+				return EXIT_FAILURE;
+			arg.resize(len);
+			if (len && !read_server_data(&arg[0], len))
+				return EXIT_FAILURE;
+		}
+
+		ServerRequest request;
+		uint32_t spirv_size;
+		if (!read_server_u32(spirv_size) || (spirv_size % sizeof(uint32_t)) != 0)
+			return EXIT_FAILURE;
+		request.spirv.resize(spirv_size / sizeof(uint32_t));
+		if (spirv_size && !read_server_data(request.spirv.data(), spirv_size))
+			return EXIT_FAILURE;
+
+		vector<char *> argv;
+		argv.reserve(arg_count + 2);
+		argv.push_back(const_cast<char *>("spirv-cross"));
+		for (auto &arg : arg_strings)
+			argv.push_back(&arg[0]);
+		argv.push_back(nullptr);
+
+		uint32_t status = uint32_t(main_protected(int(arg_count + 1), argv.data(), &request));
+		uint32_t output_size = uint32_t(request.output.size());
+		if (!write_server_data(&status, sizeof(status)) || !write_server_data(&output_size, sizeof(output_size)) ||
+		    !write_server_data(request.output.data(), request.output.size()))
+			return EXIT_FAILURE;
+		fflush(stdout);
+		fflush(stderr);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc == 2 && strcmp(argv[1], "--server") == 0)
+		return run_server();
+	else
+		return main_protected(argc, argv, nullptr);
+}
@@ -0,0 +1,37 @@
+#include <metal_stdlib>
+#include <simd/simd.h>
+
+using namespace metal;
+
+struct main0_out
+{
+    float3 vNormal [[user(locn0)]];
+    float2 vUV [[user(locn1)]];
+    float4 gl_Position [[position]];
+};
+
+struct main0_in
+{
+    float4 aPosition [[attribute(0)]];
+    float3 aNormal [[attribute(1)]];
+    float2 aUV [[attribute(2)]];
+    float4 aModel_0 [[attribute(3)]];
+    float4 aModel_1 [[attribute(4)]];
+    float4 aModel_2 [[attribute(5)]];
+    float4 aModel_3 [[attribute(6)]];
+};
+
+vertex main0_out main0(main0_in in [[stage_in]])
+{
+    main0_out out = {};
+    float4x4 aModel = {};
+    aModel[0] = in.aModel_0;
+    aModel[1] = in.aModel_1;
+    aModel[2] = in.aModel_2;
+    aModel[3] = in.aModel_3;
+    out.gl_Position = aModel * in.aPosition;
+    out.vNormal = fast::normalize(in.aNormal);
+    out.vUV = in.aUV;
+    return out;
+}
+
@@ -0,0 +1,38 @@
+cbuffer UBO : register(b0)
+{
+    row_major float4x4 _9_mvp : packoffset(c0);
+    float3 _9_light : packoffset(c4);
+};
+
+
+static float3 vNormal;
+static int vIndex;
+static float4 FragColor;
+
+struct SPIRV_Cross_Input
+{
+    float3 vNormal : TEXCOORD0;
+    nointerpolation int vIndex : TEXCOORD1;
+};
+
+struct SPIRV_Cross_Output
+{
+    float4 FragColor : SV_Target0;
+};
+
+void frag_main()
+{
+    float3 _21 = normalize(vNormal);
+    float4 _30 = mul(float4(_21, float(vIndex)), _9_mvp);
+    FragColor = float4(dot(_21, _9_light), _21.y * float(vIndex), _30.x + _30.y, _30.w);
+}
+
+SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
+{
+    vNormal = stage_input.vNormal;
+    vIndex = stage_input.vIndex;
+    frag_main();
+    SPIRV_Cross_Output stage_output;
+    stage_output.FragColor = FragColor;
+    return stage_output;
+}
@@ -0,0 +1,32 @@
+static const float _48[4] = { 0.25f, 0.5f, 0.75f, 1.0f };
+
+cbuffer UBO : register(b0)
+{
+    int ubo_index : packoffset(c0);
+    uint ubo_mode : packoffset(c0.y);
+};
+
+
+static float4 FragColor;
+
+struct SPIRV_Cross_Output
+{
+    float4 FragColor : SV_Target0;
+};
+
+void frag_main()
+{
+    float _40;
+    _40 = uint(ubo_index) < 4u ? _48[ubo_index] : 0.0f;
+    float4 color;
+    color = (ubo_mode == 1u || ubo_mode == 6u) ? float4(1.0f, 0.0f, 0.0f, 1.0f) : (ubo_mode == 5u) ? float4(0.0f, 1.0f, 0.0f, 1.0f) : 0.0f.xxxx;
+    FragColor = color * _40;
+}
+
+SPIRV_Cross_Output main()
+{
+    frag_main();
+    SPIRV_Cross_Output stage_output;
+    stage_output.FragColor = FragColor;
+    return stage_output;
+}
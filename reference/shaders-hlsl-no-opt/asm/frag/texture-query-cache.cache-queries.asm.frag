@@ -0,0 +1,40 @@
+Texture2D<float4> uTex : register(t0);
+SamplerState _uTex_sampler : register(s0);
+
+static float4 FragColor;
+static float2 vUV;
+
+struct SPIRV_Cross_Input
+{
+    float2 vUV : TEXCOORD0;
+};
+
+struct SPIRV_Cross_Output
+{
+    float4 FragColor : SV_Target0;
+};
+
+void frag_main()
+{
+    uint2 uTex_size;
+    uint uTex_levels;
+    uTex.GetDimensions(0u, uTex_size.x, uTex_size.y, uTex_levels);
+    uint2 uTex_lod1_size;
+    uint uTex_lod1_levels;
+    uTex.GetDimensions(uint(1), uTex_lod1_size.x, uTex_lod1_size.y, uTex_lod1_levels);
+    float4 _28 = 0.0f.xxxx;
+    for (int i = 0; i < 4; i++)
+    {
+        _28 += uTex.Sample(_uTex_sampler, (vUV * float(i)) / float2(int2(uTex_size)));
+    }
+    FragColor = _28 * float(int(uTex_levels) + int2(uTex_lod1_size).x);
+}
+
+SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
+{
+    vUV = stage_input.vUV;
+    frag_main();
+    SPIRV_Cross_Output stage_output;
+    stage_output.FragColor = FragColor;
+    return stage_output;
+}
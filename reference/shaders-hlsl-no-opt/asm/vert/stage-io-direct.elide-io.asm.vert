@@ -0,0 +1,48 @@
+static float4 gl_Position;
+static float4x4 aModel;
+static float4 vTint;
+
+struct SPIRV_Cross_Input
+{
+    float4 aPosition : TEXCOORD0;
+    float3 aNormal : TEXCOORD1;
+    float2 aUV : TEXCOORD2;
+    float4 aModel_0 : TEXCOORD3_0;
+    float4 aModel_1 : TEXCOORD3_1;
+    float4 aModel_2 : TEXCOORD3_2;
+    float4 aModel_3 : TEXCOORD3_3;
+};
+
+struct SPIRV_Cross_Output
+{
+    float3 vNormal : TEXCOORD0;
+    float2 vUV : TEXCOORD1;
+    float4 vTint : TEXCOORD2;
+    float4 gl_Position : SV_Position;
+};
+
+void write_tint()
+{
+    vTint = float4(0.5f, 0.5f, 0.5f, 1.0f);
+}
+
+void vert_main(SPIRV_Cross_Input stage_input, inout SPIRV_Cross_Output stage_output)
+{
+    gl_Position = mul(stage_input.aPosition, aModel);
+    stage_output.vNormal = normalize(stage_input.aNormal);
+    stage_output.vUV = stage_input.aUV;
+    write_tint();
+}
+
+SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
+{
+    aModel[0] = stage_input.aModel_0;
+    aModel[1] = stage_input.aModel_1;
+    aModel[2] = stage_input.aModel_2;
+    aModel[3] = stage_input.aModel_3;
+    SPIRV_Cross_Output stage_output = (SPIRV_Cross_Output)0;
+    vert_main(stage_input, stage_output);
+    stage_output.gl_Position = gl_Position;
+    stage_output.vTint = vTint;
+    return stage_output;
+}
@@ -0,0 +1,31 @@
+#include <metal_stdlib>
+#include <simd/simd.h>
+
+using namespace metal;
+
+struct UBO
+{
+    float4x4 mvp;
+    float3 light;
+};
+
+struct main0_out
+{
+    float4 FragColor [[color(0)]];
+};
+
+struct main0_in
+{
+    float3 vNormal [[user(locn0)]];
+    int vIndex [[user(locn1)]];
+};
+
+fragment main0_out main0(main0_in in [[stage_in]], constant UBO& _9 [[buffer(0)]])
+{
+    main0_out out = {};
+    float3 _21 = fast::normalize(in.vNormal);
+    float4 _30 = _9.mvp * float4(_21, float(in.vIndex));
+    out.FragColor = float4(dot(_21, _9.light), _21.y * float(in.vIndex), _30.x + _30.y, _30.w);
+    return out;
+}
+
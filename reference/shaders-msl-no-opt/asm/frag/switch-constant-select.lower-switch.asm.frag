@@ -0,0 +1,70 @@
+#pragma clang diagnostic ignored "-Wmissing-prototypes"
+#pragma clang diagnostic ignored "-Wmissing-braces"
+
+#include <metal_stdlib>
+#include <simd/simd.h>
+
+using namespace metal;
+
+template<typename T, size_t Num>
+struct spvUnsafeArray
+{
+    T elements[Num ? Num : 1];
+    
+    thread T& operator [] (size_t pos) thread
+    {
+        return elements[pos];
+    }
+    constexpr const thread T& operator [] (size_t pos) const thread
+    {
+        return elements[pos];
+    }
+    
+    device T& operator [] (size_t pos) device
+    {
+        return elements[pos];
+    }
+    constexpr const device T& operator [] (size_t pos) const device
+    {
+        return elements[pos];
+    }
+    
+    constexpr const constant T& operator [] (size_t pos) const constant
+    {
+        return elements[pos];
+    }
+    
+    threadgroup T& operator [] (size_t pos) threadgroup
+    {
+        return elements[pos];
+    }
+    constexpr const threadgroup T& operator [] (size_t pos) const threadgroup
+    {
+        return elements[pos];
+    }
+};
+
+struct UBO
+{
+    int index;
+    uint mode;
+};
+
+constant spvUnsafeArray<float, 4> _48 = spvUnsafeArray<float, 4>({ 0.25, 0.5, 0.75, 1.0 });
+
+struct main0_out
+{
+    float4 FragColor [[color(0)]];
+};
+
+fragment main0_out main0(constant UBO& ubo [[buffer(0)]])
+{
+    main0_out out = {};
+    float _40;
+    _40 = uint(ubo.index) < 4u ? _48[ubo.index] : 0.0;
+    float4 color;
+    color = (ubo.mode == 1u || ubo.mode == 6u) ? float4(1.0, 0.0, 0.0, 1.0) : (ubo.mode == 5u) ? float4(0.0, 1.0, 0.0, 1.0) : float4(0.0);
+    out.FragColor = color * _40;
+    return out;
+}
+
@@ -0,0 +1,30 @@
+#version 310 es
+precision mediump float;
+precision highp int;
+
+layout(binding = 0, std140) uniform UBO
+{
+    highp float scale;
+} ubo;
+
+layout(location = 0) in vec4 vColor;
+layout(location = 0) out vec4 FragColor;
+
+void main()
+{
+    float scale = ubo.scale;
+    float biased = (vColor.x * scale) + scale;
+    float acc;
+    highp float highp_acc;
+    acc = 0.0;
+    highp_acc = 0.0;
+    float acc_next;
+    highp float _37;
+    for (int i = 0; i < 4; acc = acc_next, highp_acc = _37, i++)
+    {
+        acc_next = acc + biased;
+        _37 = highp_acc + 1.0;
+    }
+    FragColor = vec4(sin(acc), highp_acc, 0.0, 1.0);
+}
+
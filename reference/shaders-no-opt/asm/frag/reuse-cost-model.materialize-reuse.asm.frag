@@ -0,0 +1,19 @@
+#version 450
+
+layout(binding = 0, std140) uniform UBO
+{
+    mat4 mvp;
+    vec3 light;
+} _9;
+
+layout(location = 0) in vec3 vNormal;
+layout(location = 1) flat in int vIndex;
+layout(location = 0) out vec4 FragColor;
+
+void main()
+{
+    vec3 _21 = normalize(vNormal);
+    vec4 _30 = _9.mvp * vec4(_21, float(vIndex));
+    FragColor = vec4(dot(_21, _9.light), _21.y * float(vIndex), _30.x + _30.y, _30.w);
+}
+
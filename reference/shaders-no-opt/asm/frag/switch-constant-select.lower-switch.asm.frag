@@ -0,0 +1,23 @@
+#version 310 es
+precision mediump float;
+precision highp int;
+
+const float _48[4] = float[](0.25, 0.5, 0.75, 1.0);
+
+layout(binding = 0, std140) uniform UBO
+{
+    int index;
+    uint mode;
+} ubo;
+
+layout(location = 0) out highp vec4 FragColor;
+
+void main()
+{
+    highp float _40;
+    _40 = uint(ubo.index) < 4u ? _48[ubo.index] : 0.0;
+    highp vec4 color;
+    color = (ubo.mode == 1u || ubo.mode == 6u) ? vec4(1.0, 0.0, 0.0, 1.0) : (ubo.mode == 5u) ? vec4(0.0, 1.0, 0.0, 1.0) : vec4(0.0);
+    FragColor = color * _40;
+}
+
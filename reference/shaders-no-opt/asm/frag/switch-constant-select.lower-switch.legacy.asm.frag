@@ -0,0 +1,21 @@
+#version 100
+precision mediump float;
+precision highp int;
+
+struct UBO
+{
+    int index;
+    int mode;
+};
+
+uniform UBO ubo;
+
+void main()
+{
+    highp float _38;
+    _38 = (ubo.index == 0) ? 0.25 : (ubo.index == 1) ? 0.5 : (ubo.index == 2) ? 0.75 : (ubo.index == 3) ? 1.0 : 0.0;
+    highp vec4 color;
+    color = (ubo.mode == 1 || ubo.mode == 6) ? vec4(1.0, 0.0, 0.0, 1.0) : (ubo.mode == 5) ? vec4(0.0, 1.0, 0.0, 1.0) : vec4(0.0);
+    gl_FragData[0] = color * _38;
+}
+
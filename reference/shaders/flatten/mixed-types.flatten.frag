@@ -0,0 +1,12 @@
+#version 310 es
+precision mediump float;
+precision highp int;
+
+uniform highp vec4 UBO[4];
+layout(location = 0) out vec4 FragColor;
+
+void main()
+{
+    FragColor = ((UBO[0] * UBO[1].z) + vec4(vec2(floatBitsToInt(UBO[1].xy)), float(floatBitsToInt(UBO[2].x)), float(floatBitsToUint(UBO[1].w)))) + vec4(UBO[3].xyz, 0.0);
+}
+
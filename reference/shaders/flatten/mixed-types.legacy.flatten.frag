@@ -0,0 +1,23 @@
+#version 100
+precision mediump float;
+precision highp int;
+
+struct Light
+{
+    vec3 position;
+    int type;
+};
+
+uniform highp vec4 UBO[6];
+varying float vIndex;
+
+void main()
+{
+    float _20 = vIndex;
+    highp float hp_copy_20 = _20;
+    int _21 = int(hp_copy_20);
+    Light _24 = Light(UBO[_21 * 1 + 1].xyz, int(UBO[_21 * 1 + 1].w));
+    Light light = Light(_24.position, _24.type);
+    gl_FragData[0] = (UBO[0] * UBO[5].y) + vec4(light.position * float(light.type), float(int(UBO[5].x)));
+}
+
@@ -0,0 +1,91 @@
+; SPIR-V
+; Version: 1.0
+; Generator: Khronos Glslang Reference Front End; 10
+; Bound: 80
+; Schema: 0
+               OpCapability Shader
+               OpCapability ImageQuery
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main" %FragColor %vUV
+               OpExecutionMode %main OriginUpperLeft
+               OpSource GLSL 450
+               OpName %main "main"
+               OpName %uTex "uTex"
+               OpName %FragColor "FragColor"
+               OpName %vUV "vUV"
+               OpName %i "i"
+               OpDecorate %uTex DescriptorSet 0
+               OpDecorate %uTex Binding 0
+               OpDecorate %FragColor Location 0
+               OpDecorate %vUV Location 0
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+      %float = OpTypeFloat 32
+        %int = OpTypeInt 32 1
+      %v2int = OpTypeVector %int 2
+    %v2float = OpTypeVector %float 2
+    %v4float = OpTypeVector %float 4
+       %bool = OpTypeBool
+         %10 = OpTypeImage %float 2D 0 0 0 1 Unknown
+         %11 = OpTypeSampledImage %10
+%_ptr_UniformConstant_11 = OpTypePointer UniformConstant %11
+       %uTex = OpVariable %_ptr_UniformConstant_11 UniformConstant
+%_ptr_Output_v4float = OpTypePointer Output %v4float
+  %FragColor = OpVariable %_ptr_Output_v4float Output
+%_ptr_Input_v2float = OpTypePointer Input %v2float
+        %vUV = OpVariable %_ptr_Input_v2float Input
+%_ptr_Function_int = OpTypePointer Function %int
+%_ptr_Function_v4float = OpTypePointer Function %v4float
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+      %int_4 = OpConstant %int 4
+    %float_0 = OpConstant %float 0
+         %20 = OpConstantComposite %v4float %float_0 %float_0 %float_0 %float_0
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+          %i = OpVariable %_ptr_Function_int Function
+        %acc = OpVariable %_ptr_Function_v4float Function
+               OpStore %i %int_0
+               OpStore %acc %20
+               OpBranch %30
+         %30 = OpLabel
+               OpLoopMerge %32 %33 None
+               OpBranch %34
+         %34 = OpLabel
+         %35 = OpLoad %int %i
+         %36 = OpSLessThan %bool %35 %int_4
+               OpBranchConditional %36 %31 %32
+         %31 = OpLabel
+         %40 = OpLoad %11 %uTex
+         %41 = OpImage %10 %40
+         %42 = OpImageQuerySizeLod %v2int %41 %int_0
+         %43 = OpConvertSToF %v2float %42
+         %44 = OpLoad %v2float %vUV
+         %45 = OpLoad %int %i
+         %46 = OpConvertSToF %float %45
+         %47 = OpVectorTimesScalar %v2float %44 %46
+         %48 = OpFDiv %v2float %47 %43
+         %49 = OpImageSampleImplicitLod %v4float %40 %48
+         %50 = OpLoad %v4float %acc
+         %51 = OpFAdd %v4float %50 %49
+               OpStore %acc %51
+               OpBranch %33
+         %33 = OpLabel
+         %52 = OpLoad %int %i
+         %53 = OpIAdd %int %52 %int_1
+               OpStore %i %53
+               OpBranch %30
+         %32 = OpLabel
+         %60 = OpLoad %11 %uTex
+         %61 = OpImage %10 %60
+         %62 = OpImageQueryLevels %int %61
+         %63 = OpImageQuerySizeLod %v2int %61 %int_1
+         %64 = OpCompositeExtract %int %63 0
+         %65 = OpIAdd %int %62 %64
+         %66 = OpConvertSToF %float %65
+         %67 = OpLoad %v4float %acc
+         %68 = OpVectorTimesScalar %v4float %67 %66
+               OpStore %FragColor %68
+               OpReturn
+               OpFunctionEnd
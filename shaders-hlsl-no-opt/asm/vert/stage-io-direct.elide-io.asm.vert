@@ -0,0 +1,72 @@
+; SPIR-V
+; Version: 1.0
+; Generator: Khronos Glslang Reference Front End; 10
+; Bound: 60
+; Schema: 0
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Vertex %main "main" %gl_Position %aPosition %aNormal %aUV %aModel %vNormal %vUV %vTint
+               OpSource GLSL 450
+               OpName %main "main"
+               OpName %write_tint_ "write_tint("
+               OpName %gl_Position "gl_Position"
+               OpName %aPosition "aPosition"
+               OpName %aNormal "aNormal"
+               OpName %aUV "aUV"
+               OpName %aModel "aModel"
+               OpName %vNormal "vNormal"
+               OpName %vUV "vUV"
+               OpName %vTint "vTint"
+               OpDecorate %gl_Position BuiltIn Position
+               OpDecorate %aPosition Location 0
+               OpDecorate %aNormal Location 1
+               OpDecorate %aUV Location 2
+               OpDecorate %aModel Location 3
+               OpDecorate %vNormal Location 0
+               OpDecorate %vUV Location 1
+               OpDecorate %vTint Location 2
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+      %float = OpTypeFloat 32
+    %v2float = OpTypeVector %float 2
+    %v3float = OpTypeVector %float 3
+    %v4float = OpTypeVector %float 4
+%mat4v4float = OpTypeMatrix %v4float 4
+    %float_1 = OpConstant %float 1
+  %float_0_5 = OpConstant %float 0.5
+         %20 = OpConstantComposite %v4float %float_0_5 %float_0_5 %float_0_5 %float_1
+%_ptr_Output_v4float = OpTypePointer Output %v4float
+%_ptr_Output_v3float = OpTypePointer Output %v3float
+%_ptr_Output_v2float = OpTypePointer Output %v2float
+%_ptr_Input_v4float = OpTypePointer Input %v4float
+%_ptr_Input_v3float = OpTypePointer Input %v3float
+%_ptr_Input_v2float = OpTypePointer Input %v2float
+%_ptr_Input_mat4v4float = OpTypePointer Input %mat4v4float
+%gl_Position = OpVariable %_ptr_Output_v4float Output
+  %aPosition = OpVariable %_ptr_Input_v4float Input
+    %aNormal = OpVariable %_ptr_Input_v3float Input
+        %aUV = OpVariable %_ptr_Input_v2float Input
+     %aModel = OpVariable %_ptr_Input_mat4v4float Input
+    %vNormal = OpVariable %_ptr_Output_v3float Output
+        %vUV = OpVariable %_ptr_Output_v2float Output
+      %vTint = OpVariable %_ptr_Output_v4float Output
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+         %30 = OpLoad %mat4v4float %aModel
+         %31 = OpLoad %v4float %aPosition
+         %32 = OpMatrixTimesVector %v4float %30 %31
+               OpStore %gl_Position %32
+         %33 = OpLoad %v3float %aNormal
+         %34 = OpExtInst %v3float %1 Normalize %33
+               OpStore %vNormal %34
+         %35 = OpLoad %v2float %aUV
+               OpStore %vUV %35
+         %36 = OpFunctionCall %void %write_tint_
+               OpReturn
+               OpFunctionEnd
+%write_tint_ = OpFunction %void None %3
+          %7 = OpLabel
+               OpStore %vTint %20
+               OpReturn
+               OpFunctionEnd
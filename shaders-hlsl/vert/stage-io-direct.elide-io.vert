@@ -0,0 +1,15 @@
+#version 450
+
+layout(location = 0) in vec4 aPosition;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aUV;
+layout(location = 3) in mat4 aModel;
+layout(location = 0) out vec3 vNormal;
+layout(location = 1) out vec2 vUV;
+
+void main()
+{
+    gl_Position = aModel * aPosition;
+    vNormal = normalize(aNormal);
+    vUV = aUV;
+}
@@ -0,0 +1,75 @@
+; SPIR-V
+; Version: 1.0
+; Generator: Khronos Glslang Reference Front End; 10
+; Bound: 60
+; Schema: 0
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main" %vNormal %vIndex %FragColor
+               OpExecutionMode %main OriginUpperLeft
+               OpSource GLSL 450
+               OpName %main "main"
+               OpName %vNormal "vNormal"
+               OpName %vIndex "vIndex"
+               OpName %UBO "UBO"
+               OpMemberName %UBO 0 "mvp"
+               OpMemberName %UBO 1 "light"
+               OpName %_ ""
+               OpName %FragColor "FragColor"
+               OpDecorate %vNormal Location 0
+               OpDecorate %vIndex Flat
+               OpDecorate %vIndex Location 1
+               OpMemberDecorate %UBO 0 ColMajor
+               OpMemberDecorate %UBO 0 Offset 0
+               OpMemberDecorate %UBO 0 MatrixStride 16
+               OpMemberDecorate %UBO 1 Offset 64
+               OpDecorate %UBO Block
+               OpDecorate %_ DescriptorSet 0
+               OpDecorate %_ Binding 0
+               OpDecorate %FragColor Location 0
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+      %float = OpTypeFloat 32
+    %v3float = OpTypeVector %float 3
+%_ptr_Input_v3float = OpTypePointer Input %v3float
+    %vNormal = OpVariable %_ptr_Input_v3float Input
+        %int = OpTypeInt 32 1
+%_ptr_Input_int = OpTypePointer Input %int
+     %vIndex = OpVariable %_ptr_Input_int Input
+    %v4float = OpTypeVector %float 4
+%mat4v4float = OpTypeMatrix %v4float 4
+        %UBO = OpTypeStruct %mat4v4float %v3float
+%_ptr_Uniform_UBO = OpTypePointer Uniform %UBO
+          %_ = OpVariable %_ptr_Uniform_UBO Uniform
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+%_ptr_Uniform_mat4v4float = OpTypePointer Uniform %mat4v4float
+%_ptr_Uniform_v3float = OpTypePointer Uniform %v3float
+%_ptr_Output_v4float = OpTypePointer Output %v4float
+  %FragColor = OpVariable %_ptr_Output_v4float Output
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+         %20 = OpLoad %v3float %vNormal
+         %21 = OpExtInst %v3float %1 Normalize %20
+         %22 = OpLoad %int %vIndex
+         %23 = OpConvertSToF %float %22
+         %24 = OpAccessChain %_ptr_Uniform_mat4v4float %_ %int_0
+         %25 = OpLoad %mat4v4float %24
+         %26 = OpCompositeExtract %float %21 0
+         %27 = OpCompositeExtract %float %21 1
+         %28 = OpCompositeExtract %float %21 2
+         %29 = OpCompositeConstruct %v4float %26 %27 %28 %23
+         %30 = OpMatrixTimesVector %v4float %25 %29
+         %31 = OpAccessChain %_ptr_Uniform_v3float %_ %int_1
+         %32 = OpLoad %v3float %31
+         %33 = OpDot %float %21 %32
+         %34 = OpFMul %float %27 %23
+         %35 = OpCompositeExtract %float %30 0
+         %36 = OpCompositeExtract %float %30 1
+         %37 = OpFAdd %float %35 %36
+         %38 = OpCompositeExtract %float %30 3
+         %39 = OpCompositeConstruct %v4float %33 %34 %37 %38
+               OpStore %FragColor %39
+               OpReturn
+               OpFunctionEnd
@@ -0,0 +1,91 @@
+; SPIR-V
+; Version: 1.0
+; Generator: Khronos Glslang Reference Front End; 10
+; Bound: 80
+; Schema: 0
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main" %FragColor
+               OpExecutionMode %main OriginUpperLeft
+               OpSource ESSL 310
+               OpName %main "main"
+               OpName %UBO "UBO"
+               OpMemberName %UBO 0 "index"
+               OpMemberName %UBO 1 "mode"
+               OpName %ubo "ubo"
+               OpName %color "color"
+               OpName %FragColor "FragColor"
+               OpMemberDecorate %UBO 0 Offset 0
+               OpMemberDecorate %UBO 1 Offset 4
+               OpDecorate %UBO Block
+               OpDecorate %ubo DescriptorSet 0
+               OpDecorate %ubo Binding 0
+               OpDecorate %FragColor Location 0
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+      %float = OpTypeFloat 32
+    %v4float = OpTypeVector %float 4
+        %int = OpTypeInt 32 1
+       %uint = OpTypeInt 32 0
+        %UBO = OpTypeStruct %int %uint
+%_ptr_Uniform_UBO = OpTypePointer Uniform %UBO
+        %ubo = OpVariable %_ptr_Uniform_UBO Uniform
+%_ptr_Uniform_int = OpTypePointer Uniform %int
+%_ptr_Uniform_uint = OpTypePointer Uniform %uint
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+%_ptr_Function_v4float = OpTypePointer Function %v4float
+%_ptr_Output_v4float = OpTypePointer Output %v4float
+  %FragColor = OpVariable %_ptr_Output_v4float Output
+    %float_0 = OpConstant %float 0
+ %float_0_25 = OpConstant %float 0.25
+  %float_0_5 = OpConstant %float 0.5
+ %float_0_75 = OpConstant %float 0.75
+    %float_1 = OpConstant %float 1
+        %red = OpConstantComposite %v4float %float_1 %float_0 %float_0 %float_1
+      %green = OpConstantComposite %v4float %float_0 %float_1 %float_0 %float_1
+       %zero = OpConstantComposite %v4float %float_0 %float_0 %float_0 %float_0
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+      %color = OpVariable %_ptr_Function_v4float Function
+         %10 = OpAccessChain %_ptr_Uniform_int %ubo %int_0
+         %11 = OpLoad %int %10
+               OpSelectionMerge %merge0 None
+               OpSwitch %11 %default0 0 %case0 1 %case1 2 %case2 3 %case3
+      %case0 = OpLabel
+               OpBranch %merge0
+      %case1 = OpLabel
+               OpBranch %merge0
+      %case2 = OpLabel
+               OpBranch %merge0
+      %case3 = OpLabel
+               OpBranch %merge0
+   %default0 = OpLabel
+               OpBranch %merge0
+     %merge0 = OpLabel
+     %weight = OpPhi %float %float_0_25 %case0 %float_0_5 %case1 %float_0_75 %case2 %float_1 %case3 %float_0 %default0
+         %20 = OpAccessChain %_ptr_Uniform_uint %ubo %int_1
+         %21 = OpLoad %uint %20
+               OpSelectionMerge %merge1 None
+               OpSwitch %21 %default1 1 %case_red 5 %case_green 6 %case_red2 9 %case_zero
+   %case_red = OpLabel
+               OpStore %color %red
+               OpBranch %merge1
+ %case_green = OpLabel
+               OpStore %color %green
+               OpBranch %merge1
+  %case_red2 = OpLabel
+               OpStore %color %red
+               OpBranch %merge1
+  %case_zero = OpLabel
+               OpStore %color %zero
+               OpBranch %merge1
+   %default1 = OpLabel
+               OpStore %color %zero
+               OpBranch %merge1
+     %merge1 = OpLabel
+         %30 = OpLoad %v4float %color
+         %31 = OpVectorTimesScalar %v4float %30 %weight
+               OpStore %FragColor %31
+               OpReturn
+               OpFunctionEnd
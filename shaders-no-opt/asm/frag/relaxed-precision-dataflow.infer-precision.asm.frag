@@ -0,0 +1,89 @@
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main" %vColor %FragColor
+               OpExecutionMode %main OriginUpperLeft
+               OpSource ESSL 310
+               OpName %main "main"
+               OpName %vColor "vColor"
+               OpName %FragColor "FragColor"
+               OpName %UBO "UBO"
+               OpMemberName %UBO 0 "scale"
+               OpName %ubo "ubo"
+               OpName %scale "scale"
+               OpName %scaled "scaled"
+               OpName %biased "biased"
+               OpName %acc "acc"
+               OpName %acc_next "acc_next"
+               OpName %i "i"
+               OpName %highp_acc "highp_acc"
+               OpDecorate %vColor RelaxedPrecision
+               OpDecorate %vColor Location 0
+               OpDecorate %FragColor RelaxedPrecision
+               OpDecorate %FragColor Location 0
+               OpMemberDecorate %UBO 0 Offset 0
+               OpDecorate %UBO Block
+               OpDecorate %ubo DescriptorSet 0
+               OpDecorate %ubo Binding 0
+               OpDecorate %color RelaxedPrecision
+               OpDecorate %color_x RelaxedPrecision
+               OpDecorate %scaled RelaxedPrecision
+               OpDecorate %biased RelaxedPrecision
+               OpDecorate %acc_next RelaxedPrecision
+               OpDecorate %sin RelaxedPrecision
+               OpDecorate %result RelaxedPrecision
+       %void = OpTypeVoid
+  %func_type = OpTypeFunction %void
+      %float = OpTypeFloat 32
+    %v4float = OpTypeVector %float 4
+        %int = OpTypeInt 32 1
+       %bool = OpTypeBool
+    %float_0 = OpConstant %float 0
+    %float_1 = OpConstant %float 1
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+      %int_4 = OpConstant %int 4
+%_ptr_Input_v4float = OpTypePointer Input %v4float
+     %vColor = OpVariable %_ptr_Input_v4float Input
+%_ptr_Output_v4float = OpTypePointer Output %v4float
+  %FragColor = OpVariable %_ptr_Output_v4float Output
+        %UBO = OpTypeStruct %float
+%_ptr_Uniform_UBO = OpTypePointer Uniform %UBO
+        %ubo = OpVariable %_ptr_Uniform_UBO Uniform
+%_ptr_Uniform_float = OpTypePointer Uniform %float
+       %main = OpFunction %void None %func_type
+      %entry = OpLabel
+      %color = OpLoad %v4float %vColor
+    %color_x = OpCompositeExtract %float %color 0
+
+               ; A highp load which is only consumed by mediump arithmetic can be loaded as mediump directly.
+  %scale_ptr = OpAccessChain %_ptr_Uniform_float %ubo %int_0
+      %scale = OpLoad %float %scale_ptr
+     %scaled = OpFMul %float %color_x %scale
+     %biased = OpFAdd %float %scaled %scale
+               OpBranch %header
+
+               ; The loop-carried PHI is only consumed by mediump arithmetic, so it can be mediump too.
+     %header = OpLabel
+        %acc = OpPhi %float %float_0 %entry %acc_next %continue
+  %highp_acc = OpPhi %float %float_0 %entry %highp_next %continue
+          %i = OpPhi %int %int_0 %entry %i_next %continue
+       %cond = OpSLessThan %bool %i %int_4
+               OpLoopMerge %merge %continue None
+               OpBranchConditional %cond %body %merge
+
+       %body = OpLabel
+   %acc_next = OpFAdd %float %acc %biased
+ %highp_next = OpFAdd %float %highp_acc %float_1
+               OpBranch %continue
+
+   %continue = OpLabel
+     %i_next = OpIAdd %int %i %int_1
+               OpBranch %header
+
+      %merge = OpLabel
+        %sin = OpExtInst %float %1 Sin %acc
+     %result = OpCompositeConstruct %v4float %sin %highp_acc %float_0 %float_1
+               OpStore %FragColor %result
+               OpReturn
+               OpFunctionEnd
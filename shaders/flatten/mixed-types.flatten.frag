@@ -0,0 +1,19 @@
+#version 310 es
+precision mediump float;
+
+layout(std140, binding = 0) uniform UBO
+{
+   vec4 color;
+   ivec2 offset;
+   float scale;
+   uint mask;
+   int count;
+   vec3 bias;
+};
+
+layout(location = 0) out vec4 FragColor;
+
+void main()
+{
+   FragColor = color * scale + vec4(vec2(offset), float(count), float(mask)) + vec4(bias, 0.0);
+}
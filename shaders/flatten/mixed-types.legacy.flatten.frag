@@ -0,0 +1,25 @@
+#version 310 es
+precision mediump float;
+
+struct Light
+{
+   vec3 position;
+   int type;
+};
+
+layout(std140, binding = 0) uniform UBO
+{
+   vec4 color;
+   Light lights[4];
+   int light_count;
+   float intensity;
+};
+
+layout(location = 0) in float vIndex;
+layout(location = 0) out vec4 FragColor;
+
+void main()
+{
+   Light light = lights[int(vIndex)];
+   FragColor = color * intensity + vec4(light.position * float(light.type), float(light_count));
+}
@@ -324,14 +324,16 @@ struct ValueSaver
 #pragma warning(pop)
 #endif
 
+// Kept at 8 bytes since every instruction in a function body has one.
+// The word count is not stored, it is always length + 1 for instructions in the stream.
 struct Instruction
 {
 	uint16_t op = 0;
-	uint16_t count = 0;
+	// SPIR-V encodes the word count in 16 bits, so the operand count always fits.
+	uint16_t length = 0;
 	// If offset is 0 (not a valid offset into the instruction stream),
 	// we have an instruction stream which is embedded in the object.
 	uint32_t offset = 0;
-	uint32_t length = 0;
 
 	inline bool is_embedded() const
 	{
@@ -437,11 +439,11 @@ using FunctionID = TypedID<TypeFunction>;
 using BlockID = TypedID<TypeBlock>;
 using ID = TypedID<TypeNone>;
 
-// Helper for Variant interface.
+// Common base for all objects held by a Variant.
+// This is deliberately not polymorphic. Objects are only ever created, copied and destroyed through
+// the ObjectPool of their concrete type, which Variant looks up by type, so objects do not need a vtable.
 struct IVariant
 {
-	virtual ~IVariant() = default;
-	virtual IVariant *clone(ObjectPoolBase *pool) = 0;
 	ID self = 0;
 
 protected:
@@ -450,12 +452,6 @@ protected:
 	IVariant &operator=(const IVariant&) = default;
 };
 
-#define SPIRV_CROSS_DECLARE_CLONE(T)                                \
-	IVariant *clone(ObjectPoolBase *pool) override                  \
-	{                                                               \
-		return static_cast<ObjectPool<T> *>(pool)->allocate(*this); \
-	}
-
 struct SPIRUndef : IVariant
 {
 	enum
@@ -468,8 +464,6 @@ struct SPIRUndef : IVariant
 	{
 	}
 	TypeID basetype;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRUndef)
 };
 
 struct SPIRString : IVariant
@@ -485,8 +479,6 @@ struct SPIRString : IVariant
 	}
 
 	std::string str;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRString)
 };
 
 // This type is only used by backends which need to access the combined image and sampler IDs separately after
@@ -506,8 +498,6 @@ struct SPIRCombinedImageSampler : IVariant
 	TypeID combined_type;
 	VariableID image;
 	VariableID sampler;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRCombinedImageSampler)
 };
 
 struct SPIRConstantOp : IVariant
@@ -529,8 +519,6 @@ struct SPIRConstantOp : IVariant
 	spv::Op opcode;
 	SmallVector<uint32_t> arguments;
 	TypeID basetype;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRConstantOp)
 };
 
 struct SPIRType : IVariant
@@ -623,8 +611,6 @@ struct SPIRType : IVariant
 
 	// Used in backends to avoid emitting members with conflicting names.
 	std::unordered_set<std::string> member_name_cache;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRType)
 };
 
 struct SPIRExtension : IVariant
@@ -654,7 +640,6 @@ struct SPIRExtension : IVariant
 	}
 
 	Extension ext;
-	SPIRV_CROSS_DECLARE_CLONE(SPIRExtension)
 };
 
 // SPIREntryPoint is not a variant since its IDs are used to decorate OpFunction,
@@ -741,8 +726,6 @@ struct SPIRExpression : IVariant
 
 	// The expression was emitted at a certain scope. Lets us track when an expression read means multiple reads.
 	uint32_t emitted_loop_level = 0;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRExpression)
 };
 
 struct SPIRFunctionPrototype : IVariant
@@ -759,8 +742,6 @@ struct SPIRFunctionPrototype : IVariant
 
 	TypeID return_type;
 	SmallVector<uint32_t> parameter_types;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRFunctionPrototype)
 };
 
 struct SPIRBlock : IVariant
@@ -911,8 +892,6 @@ struct SPIRBlock : IVariant
 	// sub-group-like operations.
 	// Make sure that we only use these expressions in the original block.
 	SmallVector<ID> invalidate_expressions;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRBlock)
 };
 
 struct SPIRFunction : IVariant
@@ -1012,8 +991,6 @@ struct SPIRFunction : IVariant
 	bool active = false;
 	bool flush_undeclared = true;
 	bool do_combined_parameters = true;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRFunction)
 };
 
 struct SPIRAccessChain : IVariant
@@ -1053,8 +1030,6 @@ struct SPIRAccessChain : IVariant
 	// By reading this expression, we implicitly read these expressions as well.
 	// Used by access chain Store and Load since we read multiple expressions in this case.
 	SmallVector<ID> implied_read_expressions;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRAccessChain)
 };
 
 struct SPIRVariable : IVariant
@@ -1111,8 +1086,6 @@ struct SPIRVariable : IVariant
 	bool loop_variable_enable = false;
 
 	SPIRFunction::Parameter *parameter = nullptr;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRVariable)
 };
 
 struct SPIRConstant : IVariant
@@ -1398,8 +1371,6 @@ struct SPIRConstant : IVariant
 	// to still be able to specialize the value by supplying corresponding
 	// preprocessor directives before compiling the shader.
 	std::string specialization_constant_macro_name;
-
-	SPIRV_CROSS_DECLARE_CLONE(SPIRConstant)
 };
 
 // Variants have a very specific allocation scheme.
@@ -1465,7 +1436,7 @@ public:
 				group->pools[type]->deallocate_opaque(holder);
 
 			if (other.holder)
-				holder = other.holder->clone(group->pools[other.type].get());
+				holder = static_cast<IVariant *>(group->pools[other.type]->clone_opaque(other.holder));
 			else
 				holder = nullptr;
 
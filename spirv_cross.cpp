@@ -2380,6 +2380,53 @@ ExecutionModel Compiler::get_execution_model() const
 	return execution.model;
 }
 
+void Compiler::validate_compiled_features() const
+{
+	auto model = get_execution_model();
+	(void)model;
+
+#ifdef SPIRV_CROSS_NO_RAY_TRACING
+	switch (model)
+	{
+	case ExecutionModelRayGenerationKHR:
+	case ExecutionModelIntersectionKHR:
+	case ExecutionModelAnyHitKHR:
+	case ExecutionModelClosestHitKHR:
+	case ExecutionModelMissKHR:
+	case ExecutionModelCallableKHR:
+		SPIRV_CROSS_THROW("Ray tracing support was compiled out (SPIRV_CROSS_NO_RAY_TRACING).");
+	default:
+		break;
+	}
+
+	for (auto cap : ir.declared_capabilities)
+		if (cap == CapabilityRayQueryKHR || cap == CapabilityRayTracingKHR || cap == CapabilityRayTracingNV)
+			SPIRV_CROSS_THROW("Ray tracing support was compiled out (SPIRV_CROSS_NO_RAY_TRACING).");
+#endif
+
+#ifdef SPIRV_CROSS_NO_MESH_SHADING
+	if (model == ExecutionModelMeshEXT || model == ExecutionModelTaskEXT || model == ExecutionModelMeshNV ||
+	    model == ExecutionModelTaskNV)
+		SPIRV_CROSS_THROW("Mesh shading support was compiled out (SPIRV_CROSS_NO_MESH_SHADING).");
+#endif
+
+#ifdef SPIRV_CROSS_NO_TESSELLATION
+	if (is_tessellation_shader(model))
+		SPIRV_CROSS_THROW("Tessellation support was compiled out (SPIRV_CROSS_NO_TESSELLATION).");
+#endif
+
+#ifdef SPIRV_CROSS_NO_AMD_EXTENSIONS
+	ir.for_each_typed_id<SPIRExtension>([](uint32_t, const SPIRExtension &ext) {
+		if (ext.ext == SPIRExtension::SPV_AMD_shader_ballot ||
+		    ext.ext == SPIRExtension::SPV_AMD_shader_explicit_vertex_parameter ||
+		    ext.ext == SPIRExtension::SPV_AMD_shader_trinary_minmax || ext.ext == SPIRExtension::SPV_AMD_gcn_shader)
+		{
+			SPIRV_CROSS_THROW("AMD extension support was compiled out (SPIRV_CROSS_NO_AMD_EXTENSIONS).");
+		}
+	});
+#endif
+}
+
 bool Compiler::is_tessellation_shader(ExecutionModel model)
 {
 	return model == ExecutionModelTessellationControl || model == ExecutionModelTessellationEvaluation;
@@ -4130,8 +4177,10 @@ void Compiler::analyze_variable_scope(SPIRFunction &entry, AnalyzeVariableScopeA
 		if (!static_loop_init)
 			continue;
 
-		// We have a loop variable.
-		header_block.loop_variables.push_back(loop_variable.first);
+		// We have a loop variable. The header already knows it if compile() ran before.
+		auto &loop_variables = header_block.loop_variables;
+		if (find(begin(loop_variables), end(loop_variables), loop_variable.first) == end(loop_variables))
+			loop_variables.push_back(loop_variable.first);
 		// Need to sort here as variables come from an unordered container, and pushing stuff in wrong order
 		// will break reproducability in regression runs.
 		sort(begin(header_block.loop_variables), end(header_block.loop_variables));
@@ -4212,6 +4261,992 @@ bool Compiler::may_read_undefined_variable_in_block(const SPIRBlock &block, uint
 	return true;
 }
 
+static uint32_t expression_reuse_cost(const SPIRType &type, Op op, const uint32_t *ops, uint32_t length)
+{
+	switch (op)
+	{
+	// Work which backends forward as expressions and which track their usage.
+	// Opcodes which only swizzle or forward data (OpCompositeExtract, OpVectorShuffle, OpCopyObject, access chains)
+	// and loads suppress usage tracking and are deliberately not considered here.
+	case OpCompositeConstruct:
+		return type.array.empty() && type.basetype != SPIRType::Struct ? 1 : 4;
+
+	case OpSNegate:
+	case OpFNegate:
+	case OpIAdd:
+	case OpFAdd:
+	case OpISub:
+	case OpFSub:
+	case OpIMul:
+	case OpFMul:
+	case OpVectorTimesScalar:
+	case OpShiftRightLogical:
+	case OpShiftRightArithmetic:
+	case OpShiftLeftLogical:
+	case OpBitwiseOr:
+	case OpBitwiseXor:
+	case OpBitwiseAnd:
+	case OpNot:
+	case OpConvertFToU:
+	case OpConvertFToS:
+	case OpConvertSToF:
+	case OpConvertUToF:
+	case OpUConvert:
+	case OpSConvert:
+	case OpFConvert:
+	case OpBitcast:
+	case OpIEqual:
+	case OpINotEqual:
+	case OpUGreaterThan:
+	case OpSGreaterThan:
+	case OpUGreaterThanEqual:
+	case OpSGreaterThanEqual:
+	case OpULessThan:
+	case OpSLessThan:
+	case OpULessThanEqual:
+	case OpSLessThanEqual:
+	case OpFOrdEqual:
+	case OpFUnordEqual:
+	case OpFOrdNotEqual:
+	case OpFUnordNotEqual:
+	case OpFOrdLessThan:
+	case OpFUnordLessThan:
+	case OpFOrdGreaterThan:
+	case OpFUnordGreaterThan:
+	case OpFOrdLessThanEqual:
+	case OpFUnordLessThanEqual:
+	case OpFOrdGreaterThanEqual:
+	case OpFUnordGreaterThanEqual:
+	case OpLogicalEqual:
+	case OpLogicalNotEqual:
+	case OpLogicalOr:
+	case OpLogicalAnd:
+	case OpLogicalNot:
+	case OpSelect:
+	case OpAny:
+	case OpAll:
+	case OpIsNan:
+	case OpIsInf:
+		return 1;
+
+	case OpUDiv:
+	case OpSDiv:
+	case OpFDiv:
+	case OpUMod:
+	case OpSRem:
+	case OpSMod:
+	case OpFRem:
+	case OpFMod:
+	case OpDot:
+		return 2;
+
+	case OpMatrixTimesScalar:
+	case OpVectorTimesMatrix:
+	case OpMatrixTimesVector:
+	case OpMatrixTimesMatrix:
+	case OpOuterProduct:
+	case OpTranspose:
+		return 4;
+
+	case OpImageSampleImplicitLod:
+	case OpImageSampleExplicitLod:
+	case OpImageSampleProjImplicitLod:
+	case OpImageSampleProjExplicitLod:
+	case OpImageSampleDrefImplicitLod:
+	case OpImageSampleDrefExplicitLod:
+	case OpImageSampleProjDrefImplicitLod:
+	case OpImageSampleProjDrefExplicitLod:
+	case OpImageFetch:
+	case OpImageGather:
+	case OpImageDrefGather:
+	case OpImageRead:
+	case OpFunctionCall:
+		return 8;
+
+	case OpExtInst:
+		if (length < 4)
+			return 0;
+
+		switch (ops[3])
+		{
+		// Out-parameter and interpolation functions are not simple expressions.
+		case GLSLstd450Modf:
+		case GLSLstd450ModfStruct:
+		case GLSLstd450Frexp:
+		case GLSLstd450FrexpStruct:
+		case GLSLstd450InterpolateAtCentroid:
+		case GLSLstd450InterpolateAtSample:
+		case GLSLstd450InterpolateAtOffset:
+			return 0;
+
+		case GLSLstd450FAbs:
+		case GLSLstd450SAbs:
+		case GLSLstd450FSign:
+		case GLSLstd450SSign:
+		case GLSLstd450Floor:
+		case GLSLstd450Ceil:
+		case GLSLstd450Trunc:
+		case GLSLstd450Round:
+		case GLSLstd450RoundEven:
+		case GLSLstd450Fract:
+		case GLSLstd450FMin:
+		case GLSLstd450UMin:
+		case GLSLstd450SMin:
+		case GLSLstd450FMax:
+		case GLSLstd450UMax:
+		case GLSLstd450SMax:
+		case GLSLstd450FClamp:
+		case GLSLstd450UClamp:
+		case GLSLstd450SClamp:
+		case GLSLstd450FMix:
+		case GLSLstd450Step:
+			return 2;
+
+		case GLSLstd450Determinant:
+		case GLSLstd450MatrixInverse:
+			return 8;
+
+		default:
+			return 4;
+		}
+
+	default:
+		return 0;
+	}
+}
+
+void Compiler::reset_expression_reuse()
+{
+	// Undo the decisions of an earlier compile(), which may have used different options.
+	for (auto id : expression_reuse_temporaries)
+		forced_temporaries.erase(id);
+	expression_reuse_temporaries.clear();
+	duplicated_expressions.clear();
+}
+
+void Compiler::analyze_expression_reuse(const std::unordered_map<uint32_t, uint32_t> &precision_aliases)
+{
+	reset_expression_reuse();
+
+	// Precision analysis in an earlier compile() may have rewritten operands to refer to a precision alias.
+	// Count such reads towards the original expression so the decisions do not depend on what was compiled before.
+	std::unordered_map<uint32_t, uint32_t> alias_sources;
+	for (auto &alias : precision_aliases)
+		alias_sources[alias.second] = alias.first;
+
+	for (auto &f : function_cfgs)
+		analyze_expression_reuse(get<SPIRFunction>(f.first), *f.second, alias_sources);
+}
+
+void Compiler::analyze_expression_reuse(const SPIRFunction &func, const CFG &cfg,
+                                        const std::unordered_map<uint32_t, uint32_t> &alias_sources)
+{
+	// A forwarded expression is stamped out once per read. The emitter normally detects multiple reads on the fly
+	// and forces a temporary, but only at the cost of another compilation pass.
+	// Instead, count the SSA reads up front and decide based on how expensive the expression tree is.
+	// Expensive expressions are bound to temporaries in the first pass,
+	// while trivial ones are allowed to be duplicated without triggering a recompile.
+	struct Candidate
+	{
+		uint32_t id;
+		uint32_t block;
+		uint32_t cost;
+		uint32_t reads;
+		SmallVector<uint32_t> operands;
+	};
+	SmallVector<Candidate> candidates;
+	std::unordered_map<uint32_t, uint32_t> candidate_index;
+	std::unordered_map<uint32_t, uint32_t> result_types;
+
+	const auto resolve_alias = [&](uint32_t id) -> uint32_t {
+		auto itr = alias_sources.find(id);
+		return itr != end(alias_sources) ? itr->second : id;
+	};
+
+	for (auto block_id : func.blocks)
+	{
+		if (!cfg.is_reachable(block_id))
+			continue;
+
+		auto &block = get<SPIRBlock>(block_id);
+		for (auto &i : block.ops)
+		{
+			auto *ops = stream(i);
+			auto op = static_cast<Op>(i.op);
+			if (i.length < 2)
+				continue;
+
+			bool has_result = false, has_result_type = false;
+			HasResultAndType(op, &has_result, &has_result_type);
+			if (!has_result || !has_result_type)
+				continue;
+			result_types[ops[1]] = ops[0];
+
+			if (op == OpExtInst && get<SPIRExtension>(ops[2]).ext != SPIRExtension::GLSL)
+				continue;
+
+			uint32_t cost = expression_reuse_cost(get<SPIRType>(ops[0]), op, ops, i.length);
+			if (cost == 0)
+				continue;
+
+			Candidate candidate = { ops[1], block_id, cost, 0, {} };
+			for (uint32_t arg = op == OpExtInst ? 4 : 2; arg < i.length; arg++)
+				candidate.operands.push_back(resolve_alias(ops[arg]));
+			candidate_index[ops[1]] = uint32_t(candidates.size());
+			candidates.push_back(std::move(candidate));
+		}
+	}
+
+	if (candidates.empty())
+		return;
+
+	const auto loop_header_of = [&](uint32_t block) -> uint32_t {
+		return get<SPIRBlock>(block).merge == SPIRBlock::MergeLoop ? block : cfg.find_loop_dominator(block);
+	};
+
+	// If we read an expression inside a loop it was not defined in, we're implicitly reading it multiple times.
+	const auto read_is_in_inner_loop = [&](uint32_t def_block, uint32_t use_block) -> bool {
+		uint32_t def_loop = loop_header_of(def_block);
+		uint32_t loop = loop_header_of(use_block);
+		if (loop == def_loop)
+			return false;
+
+		while (loop != def_loop && loop != SPIRBlock::NoDominator)
+		{
+			// The immediate dominator of a loop header lives in the enclosing scope.
+			uint32_t pre_header = cfg.get_immediate_dominator(loop);
+			if (pre_header == 0 || pre_header == loop)
+				return false;
+			loop = loop_header_of(pre_header);
+		}
+
+		return loop == def_loop;
+	};
+
+	const auto register_read = [&](uint32_t id, uint32_t use_block) {
+		auto itr = candidate_index.find(resolve_alias(id));
+		if (itr != end(candidate_index))
+		{
+			auto &candidate = candidates[itr->second];
+			candidate.reads += read_is_in_inner_loop(candidate.block, use_block) ? 2 : 1;
+		}
+	};
+
+	for (auto block_id : func.blocks)
+	{
+		if (!cfg.is_reachable(block_id))
+			continue;
+
+		auto &block = get<SPIRBlock>(block_id);
+		for (auto &i : block.ops)
+		{
+			auto *ops = stream(i);
+			uint32_t length = i.length;
+
+			// Only consider operands which may be IDs, literals could alias any ID.
+			uint32_t first = 0;
+			uint32_t count = length;
+			uint32_t literal_mask_index = UINT32_MAX;
+
+			switch (static_cast<Op>(i.op))
+			{
+			case OpLine:
+			case OpNoLine:
+				count = 0;
+				break;
+
+			case OpLoad:
+			case OpCompositeExtract:
+			case OpArrayLength:
+				first = 2;
+				count = std::min<uint32_t>(length, 3);
+				break;
+
+			case OpStore:
+			case OpCopyMemory:
+				count = std::min<uint32_t>(length, 2);
+				break;
+
+			case OpCompositeInsert:
+				first = 2;
+				count = std::min<uint32_t>(length, 4);
+				break;
+
+			case OpVectorShuffle:
+			{
+				// A plain swizzle reads the first vector once,
+				// while a shuffle between two vectors is a constructor which reads once per component.
+				if (length < 4)
+					break;
+
+				uint32_t vec0_components = 0;
+				auto type_itr = result_types.find(resolve_alias(ops[2]));
+				if (type_itr != end(result_types))
+					vec0_components = get<SPIRType>(type_itr->second).vecsize;
+				else if (ir.ids[ops[2]].get_type() == TypeConstant || ir.ids[ops[2]].get_type() == TypeVariable)
+					vec0_components = expression_type(ops[2]).vecsize;
+
+				bool shuffle = false;
+				for (uint32_t c = 4; c < length; c++)
+					if (ops[c] >= vec0_components)
+						shuffle = true;
+
+				if (shuffle)
+				{
+					for (uint32_t c = 4; c < length; c++)
+						if (ops[c] != 0xffffffffu)
+							register_read(ops[c] >= vec0_components ? ops[3] : ops[2], block_id);
+				}
+				else
+					register_read(ops[2], block_id);
+
+				count = 0;
+				break;
+			}
+
+			case OpExtInst:
+				first = 4;
+				break;
+
+			case OpImageSampleImplicitLod:
+			case OpImageSampleExplicitLod:
+			case OpImageSampleProjImplicitLod:
+			case OpImageSampleProjExplicitLod:
+			case OpImageSparseSampleImplicitLod:
+			case OpImageSparseSampleExplicitLod:
+			case OpImageSparseSampleProjImplicitLod:
+			case OpImageSparseSampleProjExplicitLod:
+			case OpImageFetch:
+			case OpImageSparseFetch:
+			case OpImageRead:
+			case OpImageSparseRead:
+				first = 2;
+				literal_mask_index = 4;
+				break;
+
+			case OpImageSampleDrefImplicitLod:
+			case OpImageSampleDrefExplicitLod:
+			case OpImageSampleProjDrefImplicitLod:
+			case OpImageSampleProjDrefExplicitLod:
+			case OpImageSparseSampleDrefImplicitLod:
+			case OpImageSparseSampleDrefExplicitLod:
+			case OpImageSparseSampleProjDrefImplicitLod:
+			case OpImageSparseSampleProjDrefExplicitLod:
+			case OpImageGather:
+			case OpImageDrefGather:
+			case OpImageSparseGather:
+			case OpImageSparseDrefGather:
+				first = 2;
+				literal_mask_index = 5;
+				break;
+
+			case OpImageWrite:
+				literal_mask_index = 3;
+				break;
+
+			default:
+			{
+				bool has_result = false, has_result_type = false;
+				HasResultAndType(static_cast<Op>(i.op), &has_result, &has_result_type);
+				first = uint32_t(has_result) + uint32_t(has_result_type);
+				break;
+			}
+			}
+
+			// An ID used several times by the same instruction is generally read once, e.g. vec4(x) for a splat.
+			for (uint32_t arg = first; arg < count; arg++)
+				if (arg != literal_mask_index && std::find(ops + first, ops + arg, ops[arg]) == ops + arg)
+					register_read(ops[arg], block_id);
+		}
+
+		for (auto &phi : block.phi_variables)
+			if (cfg.is_reachable(phi.parent))
+				register_read(phi.local_variable, phi.parent);
+
+		if (block.terminator == SPIRBlock::Select || block.terminator == SPIRBlock::MultiSelect)
+			register_read(block.condition, block_id);
+		else if (block.terminator == SPIRBlock::Return)
+			register_read(block.return_value, block_id);
+	}
+
+	// Blocks are laid out in dominance order, so operands are always resolved before their users.
+	// Operands which are read once will be forwarded into the user and count towards its cost.
+	// Only our own decisions are considered here, forced_temporaries also holds temporaries the emitter
+	// forced during an earlier compile(), which would make the result depend on what was compiled before.
+	std::unordered_set<uint32_t> bound;
+	for (auto &candidate : candidates)
+	{
+		for (auto operand : candidate.operands)
+		{
+			auto itr = candidate_index.find(operand);
+			if (itr == end(candidate_index))
+				continue;
+
+			auto &inner = candidates[itr->second];
+			if (bound.count(inner.id) == 0)
+				candidate.cost += inner.cost;
+		}
+
+		if (candidate.reads < 2)
+			continue;
+
+		// Duplicating a single cheap operation once is cheaper than the register pressure of a temporary.
+		if (candidate.cost * (candidate.reads - 1) > 1)
+		{
+			bound.insert(candidate.id);
+			if (forced_temporaries.insert(candidate.id).second)
+				expression_reuse_temporaries.push_back(candidate.id);
+		}
+		else
+			duplicated_expressions.insert(candidate.id);
+	}
+}
+
+void Compiler::restore_loop_invariant_loads()
+{
+	for (auto &original : loop_invariant_load_original_ops)
+		get<SPIRBlock>(original.first).ops = std::move(original.second);
+	loop_invariant_load_original_ops.clear();
+
+	for (auto id : loop_invariant_load_temporaries)
+		forced_temporaries.erase(id);
+	loop_invariant_load_temporaries.clear();
+}
+
+void Compiler::hoist_loop_invariant_loads()
+{
+	ir.for_each_typed_id<SPIRFunction>([&](uint32_t, SPIRFunction &func) {
+		CFG cfg(*this, func);
+		hoist_loop_invariant_loads(func, cfg);
+	});
+}
+
+bool Compiler::is_read_only_buffer_variable(const SPIRVariable &var) const
+{
+	if (var.storage == StorageClassPushConstant)
+		return true;
+
+	auto &type = get<SPIRType>(var.basetype);
+	if (type.basetype != SPIRType::Struct)
+		return false;
+
+	bool ubo = var.storage == StorageClassUniform && has_decoration(type.self, DecorationBlock);
+	bool ssbo = var.storage == StorageClassStorageBuffer ||
+	            (var.storage == StorageClassUniform && has_decoration(type.self, DecorationBufferBlock));
+	if (ubo)
+		return true;
+	if (!ssbo)
+		return false;
+
+	// Aliased buffers may be written through another binding, and coherent or volatile ones by other invocations.
+	auto flags = ir.get_buffer_block_flags(var);
+	return flags.get(DecorationNonWritable) && !flags.get(DecorationAliased) && !flags.get(DecorationCoherent) &&
+	       !flags.get(DecorationVolatile);
+}
+
+void Compiler::hoist_loop_invariant_loads(SPIRFunction &func, const CFG &cfg)
+{
+	// Unoptimized SPIR-V reloads uniforms and read-only buffers on every iteration, and since loads are forwarded,
+	// every use inside the loop body stamps out the full access expression again.
+	// Move loads which provably read the same value on every iteration to the block which enters the loop,
+	// and bind them to a temporary there.
+	SmallVector<uint32_t> loop_headers;
+	for (auto block_id : func.blocks)
+		if (cfg.is_reachable(block_id) && get<SPIRBlock>(block_id).merge == SPIRBlock::MergeLoop)
+			loop_headers.push_back(block_id);
+
+	// Inner loops are visited first in post-order, so a load hoisted out of an inner loop
+	// can be hoisted further out of the enclosing loop.
+	std::sort(loop_headers.begin(), loop_headers.end(),
+	          [&](uint32_t a, uint32_t b) { return cfg.get_visit_order(a) < cfg.get_visit_order(b); });
+
+	for (auto header_id : loop_headers)
+	{
+		auto &header = get<SPIRBlock>(header_id);
+		if (!cfg.is_reachable(header.continue_block))
+			continue;
+
+		// The loop body consists of every block which can reach the back edge without leaving through the header.
+		std::unordered_set<uint32_t> loop_blocks = { header_id };
+		SmallVector<uint32_t> work_list = { header.continue_block };
+		while (!work_list.empty())
+		{
+			uint32_t block_id = work_list.back();
+			work_list.pop_back();
+			if (!loop_blocks.insert(block_id).second)
+				continue;
+			for (auto pred : cfg.get_preceding_edges(block_id))
+				work_list.push_back(pred);
+		}
+
+		// We need a single block outside the loop which unconditionally enters it.
+		uint32_t pre_header_id = 0;
+		bool multiple_entries = false;
+		for (auto pred : cfg.get_preceding_edges(header_id))
+		{
+			if (loop_blocks.count(pred))
+				continue;
+			if (pre_header_id)
+				multiple_entries = true;
+			pre_header_id = pred;
+		}
+
+		if (!pre_header_id || multiple_entries)
+			continue;
+
+		auto &pre_header = get<SPIRBlock>(pre_header_id);
+		if (pre_header.terminator != SPIRBlock::Direct || pre_header.next_block != BlockID(header_id))
+			continue;
+
+		// Blocks which execute whenever the loop is entered.
+		// Only loads from these may read through indices which are not known to be in bounds,
+		// anything else would be speculated.
+		std::unordered_set<uint32_t> entry_blocks;
+		for (uint32_t block_id = header_id; loop_blocks.count(block_id) && entry_blocks.insert(block_id).second;)
+		{
+			auto &block = get<SPIRBlock>(block_id);
+			if (block.terminator != SPIRBlock::Direct)
+				break;
+			block_id = block.next_block;
+		}
+
+		struct Definition
+		{
+			uint32_t block;
+			const Instruction *instruction;
+		};
+		std::unordered_map<uint32_t, Definition> definitions;
+
+		for (auto block_id : func.blocks)
+		{
+			for (auto &i : get<SPIRBlock>(block_id).ops)
+			{
+				bool has_result = false, has_result_type = false;
+				HasResultAndType(static_cast<Op>(i.op), &has_result, &has_result_type);
+				if (has_result && i.length >= (has_result_type ? 2u : 1u))
+					definitions[stream(i)[has_result_type ? 1 : 0]] = { block_id, &i };
+			}
+		}
+
+		struct InvariantLoadFinder
+		{
+			Compiler &compiler;
+			const std::unordered_set<uint32_t> &loop_blocks;
+			const std::unordered_set<uint32_t> &entry_blocks;
+			const std::unordered_map<uint32_t, Definition> &definitions;
+			std::unordered_map<uint32_t, bool> results;
+			std::unordered_set<uint32_t> hoisted_ids;
+			SmallVector<uint32_t> *access_chains;
+
+			// Sets speculative if the value is not a compile-time constant.
+			bool value_is_invariant(uint32_t id, bool &speculative)
+			{
+				auto id_type = compiler.ir.ids[id].get_type();
+				if (id_type == TypeConstant || id_type == TypeConstantOp || id_type == TypeUndef)
+					return true;
+
+				speculative = true;
+				if (id_type == TypeVariable)
+					return !compiler.get<SPIRVariable>(id).phi_variable;
+
+				auto itr = definitions.find(id);
+				if (itr == end(definitions))
+					return false;
+				if (!loop_blocks.count(itr->second.block))
+					return true;
+
+				return static_cast<Op>(itr->second.instruction->op) == OpLoad && load_is_invariant(id);
+			}
+
+			const SPIRType &pointee_type(uint32_t pointer_id)
+			{
+				if (compiler.ir.ids[pointer_id].get_type() == TypeVariable)
+					return compiler.get_pointee_type(compiler.get<SPIRVariable>(pointer_id).basetype);
+				else
+					return compiler.get_pointee_type(compiler.stream(*definitions.find(pointer_id)->second.instruction)[0]);
+			}
+
+			// Sets speculative unless every index provably stays within the bounds of the type it indexes into.
+			// Runtime arrays and spec constant sized arrays have no bound to check against.
+			bool pointer_is_invariant(uint32_t id, bool &speculative)
+			{
+				if (compiler.ir.ids[id].get_type() == TypeVariable)
+					return compiler.is_read_only_buffer_variable(compiler.get<SPIRVariable>(id));
+
+				auto itr = definitions.find(id);
+				if (itr == end(definitions))
+					return false;
+
+				auto &i = *itr->second.instruction;
+				auto op = static_cast<Op>(i.op);
+				if ((op != OpAccessChain && op != OpInBoundsAccessChain) || i.length < 3)
+					return false;
+
+				auto *ops = compiler.stream(i);
+				if (!pointer_is_invariant(ops[2], speculative))
+					return false;
+
+				const auto *type = &pointee_type(ops[2]);
+				for (uint32_t index = 3; index < i.length; index++)
+				{
+					if (!value_is_invariant(ops[index], speculative))
+						return false;
+
+					auto *constant = compiler.maybe_get<SPIRConstant>(ops[index]);
+					if (type->basetype == SPIRType::Struct && type->array.empty())
+					{
+						if (!constant)
+							return false;
+						uint32_t member = constant->scalar();
+						if (member >= type->member_types.size())
+							return false;
+						type = &compiler.get<SPIRType>(type->member_types[member]);
+						continue;
+					}
+
+					uint32_t bound = 0;
+					if (!type->array.empty())
+						bound = type->array_size_literal.back() ? type->array.back() : 0;
+					else if (type->columns > 1)
+						bound = type->columns;
+					else
+						bound = type->vecsize;
+
+					if (!constant || constant->scalar() >= bound)
+						speculative = true;
+					type = &compiler.get<SPIRType>(type->parent_type);
+				}
+
+				if (loop_blocks.count(itr->second.block))
+					access_chains->push_back(id);
+				return true;
+			}
+
+			bool load_is_invariant(uint32_t id)
+			{
+				auto result_itr = results.find(id);
+				if (result_itr != end(results))
+					return result_itr->second;
+
+				auto &def = definitions.find(id)->second;
+				auto &i = *def.instruction;
+				auto *ops = compiler.stream(i);
+
+				// Only hoist values which fit in registers, not copies of entire structs or arrays.
+				auto &type = compiler.get<SPIRType>(ops[0]);
+				bool invariant = type.basetype != SPIRType::Struct && type.array.empty() && !type.pointer &&
+				                 !(i.length > 3 && (ops[3] & MemoryAccessVolatileMask) != 0);
+
+				SmallVector<uint32_t> chains;
+				auto *outer_chains = access_chains;
+				access_chains = &chains;
+
+				bool speculative = false;
+				invariant = invariant && pointer_is_invariant(ops[2], speculative);
+				if (invariant && speculative && !entry_blocks.count(def.block))
+					invariant = false;
+
+				access_chains = outer_chains;
+				if (invariant)
+				{
+					hoisted_ids.insert(chains.begin(), chains.end());
+					hoisted_ids.insert(id);
+				}
+
+				results[id] = invariant;
+				return invariant;
+			}
+		};
+
+		InvariantLoadFinder finder = { *this, loop_blocks, entry_blocks, definitions, {}, {}, nullptr };
+		for (auto block_id : func.blocks)
+		{
+			if (!loop_blocks.count(block_id))
+				continue;
+			for (auto &i : get<SPIRBlock>(block_id).ops)
+				if (static_cast<Op>(i.op) == OpLoad && i.length >= 3)
+					finder.load_is_invariant(stream(i)[1]);
+		}
+
+		if (finder.hoisted_ids.empty())
+			continue;
+
+		// The pass rewrites the IR, so keep the original instructions around to undo it on the next compile.
+		loop_invariant_load_original_ops.emplace(pre_header_id, pre_header.ops);
+
+		// Blocks are laid out in dominance order, so moving instructions in order keeps definitions before uses.
+		for (auto block_id : func.blocks)
+		{
+			if (!loop_blocks.count(block_id))
+				continue;
+
+			auto &block = get<SPIRBlock>(block_id);
+			loop_invariant_load_original_ops.emplace(block_id, block.ops);
+			SmallVector<Instruction> kept_ops;
+			for (auto &i : block.ops)
+			{
+				auto op = static_cast<Op>(i.op);
+				if ((op == OpLoad || op == OpAccessChain || op == OpInBoundsAccessChain) &&
+				    finder.hoisted_ids.count(stream(i)[1]))
+				{
+					pre_header.ops.push_back(i);
+					if (op == OpLoad && forced_temporaries.insert(stream(i)[1]).second)
+						loop_invariant_load_temporaries.push_back(stream(i)[1]);
+				}
+				else
+					kept_ops.push_back(i);
+			}
+			block.ops = std::move(kept_ops);
+		}
+	}
+}
+
+void Compiler::reset_constant_switches()
+{
+	// Lookup tables stay in the IR so a later compile() can reuse them, but must only be declared when used.
+	constant_switches.clear();
+	for (auto &table : constant_switch_lookup_tables)
+		get<SPIRConstant>(table.second).is_used_as_lut = false;
+}
+
+void Compiler::analyze_constant_switches(bool allow_lookup_tables)
+{
+	reset_constant_switches();
+	for (auto &f : function_cfgs)
+	{
+		auto &func = get<SPIRFunction>(f.first);
+
+		// Expressions do not exist yet, so find the selector types from the instructions.
+		std::unordered_map<uint32_t, uint32_t> result_types;
+		for (auto block_id : func.blocks)
+		{
+			for (auto &i : get<SPIRBlock>(block_id).ops)
+			{
+				bool has_result = false, has_result_type = false;
+				HasResultAndType(static_cast<Op>(i.op), &has_result, &has_result_type);
+				if (has_result && has_result_type && i.length >= 2)
+					result_types[stream(i)[1]] = stream(i)[0];
+			}
+		}
+
+		for (auto block_id : func.blocks)
+		{
+			auto &block = get<SPIRBlock>(block_id);
+			if (block.terminator != SPIRBlock::MultiSelect || !f.second->is_reachable(block_id))
+				continue;
+
+			uint32_t selector_type = 0;
+			auto itr = result_types.find(block.condition);
+			if (itr != end(result_types))
+				selector_type = itr->second;
+			else if (ir.ids[block.condition].get_type() == TypeConstant ||
+			         ir.ids[block.condition].get_type() == TypeVariable)
+				selector_type = expression_type_id(block.condition);
+
+			if (selector_type)
+				analyze_constant_switch(block, get<SPIRType>(selector_type), *f.second, allow_lookup_tables);
+		}
+	}
+}
+
+void Compiler::analyze_constant_switch(const SPIRBlock &block, const SPIRType &selector_type, const CFG &cfg,
+                                       bool allow_lookup_tables)
+{
+	// Look for switches where every case label only picks a constant for one or more variables
+	// consumed in the merge block, either as OpPhi in the merge block or as a single OpStore per case.
+	// These can be emitted as a constant array lookup or a chain of ternary selects instead.
+	if (block.merge != SPIRBlock::MergeSelection)
+		return;
+
+	if ((selector_type.basetype != SPIRType::Int && selector_type.basetype != SPIRType::UInt) ||
+	    selector_type.width != 32 || selector_type.vecsize != 1)
+		return;
+
+	// Breaking out of a loop or continuing from the merge block needs the regular switch path.
+	uint32_t merge_block_id = block.next_block;
+	if ((ir.block_meta[merge_block_id] & (ParsedIR::BLOCK_META_LOOP_MERGE_BIT | ParsedIR::BLOCK_META_CONTINUE_BIT)) != 0)
+		return;
+
+	auto &cases = get_case_list(block);
+	if (cases.empty() || cases.size() > ConstantSwitchMaxCases)
+		return;
+
+	// Every distinct target is either the merge block or a trivial block which branches straight to it.
+	SmallVector<uint32_t> targets = { block.default_block };
+	for (auto &c : cases)
+		if (std::find(targets.begin(), targets.end(), c.block) == targets.end())
+			targets.push_back(c.block);
+
+	struct CaseStore
+	{
+		uint32_t target;
+		uint32_t variable;
+		uint32_t value;
+	};
+	SmallVector<CaseStore> stores;
+
+	for (auto target : targets)
+	{
+		if (target == merge_block_id)
+			continue;
+
+		auto &case_block = get<SPIRBlock>(target);
+		if (case_block.terminator != SPIRBlock::Direct || case_block.next_block != merge_block_id ||
+		    case_block.merge != SPIRBlock::MergeNone || !case_block.phi_variables.empty() ||
+		    !case_block.dominated_variables.empty() || !case_block.declare_temporary.empty() ||
+		    !case_block.potential_declare_temporary.empty() || !case_block.loop_variables.empty())
+			return;
+
+		auto &preds = cfg.get_preceding_edges(target);
+		if (preds.size() != 1 || preds.front() != block.self)
+			return;
+
+		bool has_store = false;
+		for (auto &i : case_block.ops)
+		{
+			auto op = static_cast<Op>(i.op);
+			if (op == OpLine || op == OpNoLine || op == OpNop)
+				continue;
+
+			auto *ops = stream(i);
+			if (op != OpStore || has_store || i.length < 2 || ir.ids[ops[1]].get_type() != TypeConstant)
+				return;
+
+			auto *var = maybe_get<SPIRVariable>(ops[0]);
+			if (!var || var->storage != StorageClassFunction || var->phi_variable || var->loop_variable ||
+			    var->statically_assigned)
+				return;
+
+			stores.push_back({ target, ops[0], ops[1] });
+			has_store = true;
+		}
+	}
+
+	// All phi inputs must come from the switch.
+	auto &merge_block = get<SPIRBlock>(merge_block_id);
+	for (auto pred : cfg.get_preceding_edges(merge_block_id))
+		if (pred != block.self && std::find(targets.begin(), targets.end(), pred) == targets.end())
+			return;
+
+	ConstantSwitch constant_switch;
+	for (auto &c : cases)
+	{
+		// Case labels which share the default block are the default.
+		if (c.block != block.default_block)
+			constant_switch.case_literals.push_back(uint32_t(c.value));
+	}
+
+	const auto value_for_target = [&](const ConstantSwitchOutput &output, uint32_t target) -> uint32_t {
+		auto &var = get<SPIRVariable>(output.variable);
+		if (var.phi_variable)
+		{
+			uint32_t from = target == merge_block_id ? uint32_t(block.self) : target;
+			for (auto &phi : merge_block.phi_variables)
+				if (phi.function_variable == output.variable && phi.parent == from)
+					return phi.local_variable;
+			return UINT32_MAX;
+		}
+
+		for (auto &store : stores)
+			if (store.target == target && store.variable == output.variable)
+				return store.value;
+		return 0;
+	};
+
+	SmallVector<uint32_t> output_variables;
+	for (auto &phi : merge_block.phi_variables)
+		if (std::find(output_variables.begin(), output_variables.end(), phi.function_variable) == output_variables.end())
+			output_variables.push_back(phi.function_variable);
+	for (auto &store : stores)
+		if (std::find(output_variables.begin(), output_variables.end(), store.variable) == output_variables.end())
+			output_variables.push_back(store.variable);
+
+	if (output_variables.empty())
+		return;
+
+	for (auto variable : output_variables)
+	{
+		auto &var = get<SPIRVariable>(variable);
+		if (var.loop_variable)
+			return;
+
+		ConstantSwitchOutput output;
+		output.variable = variable;
+
+		output.default_value = value_for_target(output, block.default_block);
+		for (auto &c : cases)
+			if (c.block != block.default_block)
+				output.case_values.push_back(value_for_target(output, c.block));
+
+		bool lookup_table = allow_lookup_tables && output.default_value != 0;
+		const auto check_value = [&](uint32_t value) -> bool {
+			if (value == UINT32_MAX || (value != 0 && ir.ids[value].get_type() != TypeConstant))
+				return false;
+
+			if (value != 0)
+			{
+				auto &c = get<SPIRConstant>(value);
+				auto &type = get<SPIRType>(c.constant_type);
+				if (c.specialization || !type.array.empty() || type.columns != 1 || type.basetype == SPIRType::Struct)
+					lookup_table = false;
+			}
+			else
+				lookup_table = false;
+			return true;
+		};
+
+		if (!check_value(output.default_value))
+			return;
+		for (auto value : output.case_values)
+			if (!check_value(value))
+				return;
+
+		// Only use a table if the labels are non-negative and cover at least half of it.
+		uint32_t table_size = 0;
+		for (auto literal : constant_switch.case_literals)
+		{
+			if (selector_type.basetype == SPIRType::Int && int32_t(literal) < 0)
+				lookup_table = false;
+			else
+				table_size = std::max(table_size, literal + 1);
+		}
+
+		if (lookup_table && constant_switch.case_literals.size() >= ConstantSwitchMinLookupTableCases &&
+		    table_size <= ConstantSwitchMaxCases && constant_switch.case_literals.size() * 2 >= table_size)
+		{
+			// The table only depends on the IR, so reuse the one an earlier compile() created.
+			uint64_t key = (uint64_t(block.self) << 32) | variable;
+			auto &table_id = constant_switch_lookup_tables[key];
+			if (!table_id)
+			{
+				SmallVector<uint32_t> elements;
+				elements.resize_uninitialized(table_size);
+				std::fill(elements.begin(), elements.end(), output.default_value);
+				for (size_t i = 0; i < constant_switch.case_literals.size(); i++)
+					elements[constant_switch.case_literals[i]] = output.case_values[i];
+
+				uint32_t ids = ir.increase_bound_by(2);
+				uint32_t element_type_id = get<SPIRConstant>(output.default_value).constant_type;
+				SPIRType array_type = get<SPIRType>(element_type_id);
+				array_type.array.push_back(table_size);
+				array_type.array_size_literal.push_back(true);
+				array_type.parent_type = element_type_id;
+				set<SPIRType>(ids, array_type);
+
+				set<SPIRConstant>(ids + 1, ids, elements.data(), table_size, false);
+				table_id = ids + 1;
+			}
+
+			get<SPIRConstant>(table_id).is_used_as_lut = true;
+			output.lookup_table = table_id;
+		}
+
+		constant_switch.outputs.push_back(std::move(output));
+	}
+
+	constant_switches[block.self] = std::move(constant_switch);
+}
+
 Bitset Compiler::get_buffer_block_flags(VariableID id) const
 {
 	return ir.get_buffer_block_flags(get<SPIRVariable>(id));
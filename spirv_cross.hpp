@@ -779,6 +779,10 @@ protected:
 	void set_ir(ParsedIR &&parsed);
 	void parse_fixup();
 
+	// Throws if the module needs a feature which was compiled out with one of the
+	// SPIRV_CROSS_NO_* build flags, before a backend reaches the stripped code.
+	void validate_compiled_features() const;
+
 	// Used internally to implement various traversals for queries.
 	struct OpcodeHandler
 	{
@@ -904,8 +908,6 @@ protected:
 
 	bool traverse_all_reachable_opcodes(const SPIRBlock &block, OpcodeHandler &handler) const;
 	bool traverse_all_reachable_opcodes(const SPIRFunction &block, OpcodeHandler &handler) const;
-	// This must be an ordered data structure so we always pick the same type aliases.
-	SmallVector<uint32_t> global_struct_cache;
 
 	ShaderResources get_shader_resources(const std::unordered_set<VariableID> *active_variables) const;
 
@@ -918,6 +920,40 @@ protected:
 	std::unordered_set<uint32_t> suppressed_usage_tracking;
 	std::unordered_set<uint32_t> hoisted_temporaries;
 	std::unordered_set<uint32_t> forced_invariant_temporaries;
+	// Expressions which analyze_expression_reuse() deemed cheap enough to duplicate on every read.
+	std::unordered_set<uint32_t> duplicated_expressions;
+	// Temporaries forced by analyze_expression_reuse(), removed again before the next compile().
+	SmallVector<uint32_t> expression_reuse_temporaries;
+
+	// Switches found by analyze_constant_switches() which only select constants,
+	// and are emitted as a lookup table or ternary selects instead of a switch statement.
+	enum
+	{
+		ConstantSwitchMaxCases = 16,
+		ConstantSwitchMinLookupTableCases = 3
+	};
+	struct ConstantSwitchOutput
+	{
+		// Phi variable in the merge block or function variable written by the case labels.
+		uint32_t variable = 0;
+		// Parallel to ConstantSwitch::case_literals. 0 means the variable keeps its current value.
+		SmallVector<uint32_t> case_values;
+		uint32_t default_value = 0;
+		// Constant array indexed by the selector, if the case labels are dense enough.
+		uint32_t lookup_table = 0;
+	};
+	struct ConstantSwitch
+	{
+		SmallVector<uint32_t> case_literals;
+		SmallVector<ConstantSwitchOutput> outputs;
+	};
+	std::unordered_map<uint32_t, ConstantSwitch> constant_switches;
+	// Lookup tables created for a (switch block, output variable) pair, kept across compiles.
+	std::unordered_map<uint64_t, uint32_t> constant_switch_lookup_tables;
+
+	// Block instructions before hoist_loop_invariant_loads() rewrote them, and the temporaries it forced.
+	std::unordered_map<uint32_t, SmallVector<Instruction>> loop_invariant_load_original_ops;
+	SmallVector<uint32_t> loop_invariant_load_temporaries;
 
 	Bitset active_input_builtins;
 	Bitset active_output_builtins;
@@ -1066,6 +1102,18 @@ protected:
 	void find_function_local_luts(SPIRFunction &function, const AnalyzeVariableScopeAccessHandler &handler,
 	                              bool single_function);
 	bool may_read_undefined_variable_in_block(const SPIRBlock &block, uint32_t var);
+	void reset_expression_reuse();
+	void analyze_expression_reuse(const std::unordered_map<uint32_t, uint32_t> &precision_aliases);
+	void analyze_expression_reuse(const SPIRFunction &func, const CFG &cfg,
+	                              const std::unordered_map<uint32_t, uint32_t> &alias_sources);
+	void restore_loop_invariant_loads();
+	void hoist_loop_invariant_loads();
+	void hoist_loop_invariant_loads(SPIRFunction &func, const CFG &cfg);
+	bool is_read_only_buffer_variable(const SPIRVariable &var) const;
+	void reset_constant_switches();
+	void analyze_constant_switches(bool allow_lookup_tables);
+	void analyze_constant_switch(const SPIRBlock &block, const SPIRType &selector_type, const CFG &cfg,
+	                             bool allow_lookup_tables);
 
 	// Finds all resources that are written to from inside the critical section, if present.
 	// The critical section is delimited by OpBeginInvocationInterlockEXT and
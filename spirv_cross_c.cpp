@@ -74,6 +74,9 @@
 #define SPVC_END_SAFE_SCOPE(context, error)
 #endif
 
+// Routes container allocations made by the library through the context's allocator, if any.
+#define SPVC_ALLOCATION_SCOPE(context) AllocationScope spvc_allocation_scope((context)->get_allocation_callbacks())
+
 using namespace std;
 using namespace SPIRV_CROSS_NAMESPACE;
 
@@ -111,6 +114,13 @@ static inline std::unique_ptr<T> spvc_allocate(Ts &&... ts)
 
 struct spvc_context_s
 {
+	AllocationCallbacks allocation_callbacks = {};
+	bool has_allocation_callbacks = false;
+	const AllocationCallbacks *get_allocation_callbacks() const
+	{
+		return has_allocation_callbacks ? &allocation_callbacks : nullptr;
+	}
+
 	string last_error;
 	SmallVector<unique_ptr<ScratchMemoryAllocation>> allocations;
 	const char *allocate_name(const std::string &name);
@@ -129,6 +139,7 @@ void spvc_context_s::report_error(std::string msg)
 
 const char *spvc_context_s::allocate_name(const std::string &name)
 {
+	SPVC_ALLOCATION_SCOPE(this);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto alloc = spvc_allocate<StringAllocation>(name);
@@ -216,8 +227,28 @@ spvc_result spvc_context_create(spvc_context *context)
 	return SPVC_SUCCESS;
 }
 
+spvc_result spvc_context_create_with_allocator(const spvc_allocation_callbacks *allocator, spvc_context *context)
+{
+	if (!allocator || !allocator->allocate || !allocator->free)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	auto *ctx = new (std::nothrow) spvc_context_s;
+	if (!ctx)
+		return SPVC_ERROR_OUT_OF_MEMORY;
+
+	ctx->allocation_callbacks.userdata = allocator->userdata;
+	ctx->allocation_callbacks.allocate = allocator->allocate;
+	ctx->allocation_callbacks.free = allocator->free;
+	ctx->has_allocation_callbacks = true;
+
+	*context = ctx;
+	return SPVC_SUCCESS;
+}
+
 void spvc_context_destroy(spvc_context context)
 {
+	// Tearing down object pools can still allocate, so keep the callbacks installed.
+	AllocationScope scope(context->get_allocation_callbacks());
 	delete context;
 }
 
@@ -240,6 +271,7 @@ SPVC_PUBLIC_API void spvc_context_set_error_callback(spvc_context context, spvc_
 spvc_result spvc_context_parse_spirv(spvc_context context, const SpvId *spirv, size_t word_count,
                                      spvc_parsed_ir *parsed_ir)
 {
+	SPVC_ALLOCATION_SCOPE(context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		std::unique_ptr<spvc_parsed_ir_s> pir(new (std::nothrow) spvc_parsed_ir_s);
@@ -263,6 +295,7 @@ spvc_result spvc_context_parse_spirv(spvc_context context, const SpvId *spirv, s
 spvc_result spvc_context_create_compiler(spvc_context context, spvc_backend backend, spvc_parsed_ir parsed_ir,
                                          spvc_capture_mode mode, spvc_compiler *compiler)
 {
+	SPVC_ALLOCATION_SCOPE(context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		std::unique_ptr<spvc_compiler_s> comp(new (std::nothrow) spvc_compiler_s);
@@ -348,6 +381,7 @@ spvc_result spvc_context_create_compiler(spvc_context context, spvc_backend back
 
 spvc_result spvc_compiler_create_compiler_options(spvc_compiler compiler, spvc_compiler_options *options)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		std::unique_ptr<spvc_compiler_options_s> opt(new (std::nothrow) spvc_compiler_options_s);
@@ -479,9 +513,21 @@ spvc_result spvc_compiler_options_set_uint(spvc_compiler_options options, spvc_c
 	case SPVC_COMPILER_OPTION_RELAX_NAN_CHECKS:
 		options->glsl.relax_nan_checks = value != 0;
 		break;
+	case SPVC_COMPILER_OPTION_MATERIALIZE_REUSED_EXPRESSIONS:
+		options->glsl.materialize_reused_expressions = value != 0;
+		break;
+	case SPVC_COMPILER_OPTION_HOIST_LOOP_INVARIANT_LOADS:
+		options->glsl.hoist_loop_invariant_loads = value != 0;
+		break;
+	case SPVC_COMPILER_OPTION_LOWER_CONSTANT_SWITCHES:
+		options->glsl.lower_constant_switches = value != 0;
+		break;
 	case SPVC_COMPILER_OPTION_GLSL_ENABLE_ROW_MAJOR_LOAD_WORKAROUND:
 		options->glsl.enable_row_major_load_workaround = value != 0;
 		break;
+	case SPVC_COMPILER_OPTION_GLSL_INFER_RELAXED_PRECISION:
+		options->glsl.infer_relaxed_precision = value != 0;
+		break;
 #endif
 
 #if SPIRV_CROSS_C_API_HLSL
@@ -516,6 +562,22 @@ spvc_result spvc_compiler_options_set_uint(spvc_compiler_options options, spvc_c
 	case SPVC_COMPILER_OPTION_HLSL_FLATTEN_MATRIX_VERTEX_INPUT_SEMANTICS:
 		options->hlsl.flatten_matrix_vertex_input_semantics = value != 0;
 		break;
+
+	case SPVC_COMPILER_OPTION_HLSL_INFER_STRUCTURED_BUFFERS:
+		options->hlsl.infer_structured_buffers = value != 0;
+		break;
+
+	case SPVC_COMPILER_OPTION_HLSL_INFER_TYPED_BUFFERS:
+		options->hlsl.infer_typed_buffers = value != 0;
+		break;
+
+	case SPVC_COMPILER_OPTION_HLSL_ELIDE_STAGE_IO_COPIES:
+		options->hlsl.elide_stage_io_copies = value != 0;
+		break;
+
+	case SPVC_COMPILER_OPTION_HLSL_CACHE_TEXTURE_QUERIES:
+		options->hlsl.cache_texture_queries = value != 0;
+		break;
 #endif
 
 #if SPIRV_CROSS_C_API_MSL
@@ -742,6 +804,10 @@ spvc_result spvc_compiler_options_set_uint(spvc_compiler_options options, spvc_c
 	case SPVC_COMPILER_OPTION_MSL_SAMPLE_DREF_LOD_ARRAY_AS_GRAD:
 		options->msl.sample_dref_lod_array_as_grad = value != 0;
 		break;
+
+	case SPVC_COMPILER_OPTION_MSL_MINIMIZE_PACKED_STRUCT_MEMBERS:
+		options->msl.minimize_packed_struct_members = value != 0;
+		break;
 #endif
 
 	default:
@@ -754,6 +820,7 @@ spvc_result spvc_compiler_options_set_uint(spvc_compiler_options options, spvc_c
 
 spvc_result spvc_compiler_install_compiler_options(spvc_compiler compiler, spvc_compiler_options options)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	(void)options;
 	switch (compiler->backend)
 	{
@@ -786,6 +853,7 @@ spvc_result spvc_compiler_install_compiler_options(spvc_compiler compiler, spvc_
 
 spvc_result spvc_compiler_add_header_line(spvc_compiler compiler, const char *line)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_GLSL
 	if (compiler->backend == SPVC_BACKEND_NONE)
 	{
@@ -804,6 +872,7 @@ spvc_result spvc_compiler_add_header_line(spvc_compiler compiler, const char *li
 
 spvc_result spvc_compiler_require_extension(spvc_compiler compiler, const char *line)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_GLSL
 	if (compiler->backend == SPVC_BACKEND_NONE)
 	{
@@ -859,6 +928,7 @@ const char *spvc_compiler_get_required_extension(spvc_compiler compiler, size_t
 
 spvc_result spvc_compiler_flatten_buffer_block(spvc_compiler compiler, spvc_variable_id id)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_GLSL
 	if (compiler->backend == SPVC_BACKEND_NONE)
 	{
@@ -895,6 +965,7 @@ spvc_bool spvc_compiler_variable_is_depth_or_compare(spvc_compiler compiler, spv
 spvc_result spvc_compiler_mask_stage_output_by_location(spvc_compiler compiler,
                                                         unsigned location, unsigned component)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_GLSL
 	if (compiler->backend == SPVC_BACKEND_NONE)
 	{
@@ -914,6 +985,7 @@ spvc_result spvc_compiler_mask_stage_output_by_location(spvc_compiler compiler,
 
 spvc_result spvc_compiler_mask_stage_output_by_builtin(spvc_compiler compiler, SpvBuiltIn builtin)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_GLSL
 	if (compiler->backend == SPVC_BACKEND_NONE)
 	{
@@ -934,6 +1006,7 @@ spvc_result spvc_compiler_hlsl_set_root_constants_layout(spvc_compiler compiler,
                                                          const spvc_hlsl_root_constants *constant_info,
                                                          size_t count)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_HLSL
 	if (compiler->backend != SPVC_BACKEND_HLSL)
 	{
@@ -968,6 +1041,7 @@ spvc_result spvc_compiler_hlsl_add_vertex_attribute_remap(spvc_compiler compiler
                                                           const spvc_hlsl_vertex_attribute_remap *remap,
                                                           size_t count)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_HLSL
 	if (compiler->backend != SPVC_BACKEND_HLSL)
 	{
@@ -995,6 +1069,7 @@ spvc_result spvc_compiler_hlsl_add_vertex_attribute_remap(spvc_compiler compiler
 
 spvc_variable_id spvc_compiler_hlsl_remap_num_workgroups_builtin(spvc_compiler compiler)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_HLSL
 	if (compiler->backend != SPVC_BACKEND_HLSL)
 	{
@@ -1013,6 +1088,7 @@ spvc_variable_id spvc_compiler_hlsl_remap_num_workgroups_builtin(spvc_compiler c
 spvc_result spvc_compiler_hlsl_set_resource_binding_flags(spvc_compiler compiler,
                                                           spvc_hlsl_binding_flags flags)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_HLSL
 	if (compiler->backend != SPVC_BACKEND_HLSL)
 	{
@@ -1033,6 +1109,7 @@ spvc_result spvc_compiler_hlsl_set_resource_binding_flags(spvc_compiler compiler
 spvc_result spvc_compiler_hlsl_add_resource_binding(spvc_compiler compiler,
                                                     const spvc_hlsl_resource_binding *binding)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_HLSL
 	if (compiler->backend != SPVC_BACKEND_HLSL)
 	{
@@ -1193,6 +1270,7 @@ spvc_bool spvc_compiler_msl_needs_input_threadgroup_mem(spvc_compiler compiler)
 
 spvc_result spvc_compiler_msl_add_vertex_attribute(spvc_compiler compiler, const spvc_msl_vertex_attribute *va)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1216,6 +1294,7 @@ spvc_result spvc_compiler_msl_add_vertex_attribute(spvc_compiler compiler, const
 
 spvc_result spvc_compiler_msl_add_shader_input(spvc_compiler compiler, const spvc_msl_shader_interface_var *si)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1240,6 +1319,7 @@ spvc_result spvc_compiler_msl_add_shader_input(spvc_compiler compiler, const spv
 
 spvc_result spvc_compiler_msl_add_shader_input_2(spvc_compiler compiler, const spvc_msl_shader_interface_var_2 *si)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1265,6 +1345,7 @@ spvc_result spvc_compiler_msl_add_shader_input_2(spvc_compiler compiler, const s
 
 spvc_result spvc_compiler_msl_add_shader_output(spvc_compiler compiler, const spvc_msl_shader_interface_var *so)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1289,6 +1370,7 @@ spvc_result spvc_compiler_msl_add_shader_output(spvc_compiler compiler, const sp
 
 spvc_result spvc_compiler_msl_add_shader_output_2(spvc_compiler compiler, const spvc_msl_shader_interface_var_2 *so)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1315,6 +1397,7 @@ spvc_result spvc_compiler_msl_add_shader_output_2(spvc_compiler compiler, const
 spvc_result spvc_compiler_msl_add_resource_binding(spvc_compiler compiler,
                                                    const spvc_msl_resource_binding *binding)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1341,6 +1424,7 @@ spvc_result spvc_compiler_msl_add_resource_binding(spvc_compiler compiler,
 
 spvc_result spvc_compiler_msl_add_dynamic_buffer(spvc_compiler compiler, unsigned desc_set, unsigned binding, unsigned index)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1362,6 +1446,7 @@ spvc_result spvc_compiler_msl_add_dynamic_buffer(spvc_compiler compiler, unsigne
 
 spvc_result spvc_compiler_msl_add_inline_uniform_block(spvc_compiler compiler, unsigned desc_set, unsigned binding)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1382,6 +1467,7 @@ spvc_result spvc_compiler_msl_add_inline_uniform_block(spvc_compiler compiler, u
 
 spvc_result spvc_compiler_msl_add_discrete_descriptor_set(spvc_compiler compiler, unsigned desc_set)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1401,6 +1487,7 @@ spvc_result spvc_compiler_msl_add_discrete_descriptor_set(spvc_compiler compiler
 
 spvc_result spvc_compiler_msl_set_argument_buffer_device_address_space(spvc_compiler compiler, unsigned desc_set, spvc_bool device_address)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1484,6 +1571,7 @@ spvc_bool spvc_compiler_msl_is_resource_used(spvc_compiler compiler, SpvExecutio
 
 spvc_result spvc_compiler_msl_set_combined_sampler_suffix(spvc_compiler compiler, const char *suffix)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1558,6 +1646,7 @@ static void spvc_convert_msl_sampler_ycbcr_conversion(MSLConstexprSampler &samp,
 spvc_result spvc_compiler_msl_remap_constexpr_sampler(spvc_compiler compiler, spvc_variable_id id,
                                                       const spvc_msl_constexpr_sampler *sampler)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1582,6 +1671,7 @@ spvc_result spvc_compiler_msl_remap_constexpr_sampler_by_binding(spvc_compiler c
                                                                  unsigned desc_set, unsigned binding,
                                                                  const spvc_msl_constexpr_sampler *sampler)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1607,6 +1697,7 @@ spvc_result spvc_compiler_msl_remap_constexpr_sampler_ycbcr(spvc_compiler compil
                                                             const spvc_msl_constexpr_sampler *sampler,
                                                             const spvc_msl_sampler_ycbcr_conversion *conv)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1634,6 +1725,7 @@ spvc_result spvc_compiler_msl_remap_constexpr_sampler_by_binding_ycbcr(spvc_comp
                                                                        const spvc_msl_constexpr_sampler *sampler,
                                                                        const spvc_msl_sampler_ycbcr_conversion *conv)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1660,6 +1752,7 @@ spvc_result spvc_compiler_msl_remap_constexpr_sampler_by_binding_ycbcr(spvc_comp
 spvc_result spvc_compiler_msl_set_fragment_output_components(spvc_compiler compiler, unsigned location,
                                                              unsigned components)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 #if SPIRV_CROSS_C_API_MSL
 	if (compiler->backend != SPVC_BACKEND_MSL)
 	{
@@ -1716,6 +1809,7 @@ unsigned spvc_compiler_msl_get_automatic_resource_binding_secondary(spvc_compile
 
 spvc_result spvc_compiler_compile(spvc_compiler compiler, const char **source)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto result = compiler->compiler->compile();
@@ -1817,6 +1911,7 @@ bool spvc_resources_s::copy_resources(const ShaderResources &resources)
 
 spvc_result spvc_compiler_get_active_interface_variables(spvc_compiler compiler, spvc_set *set)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		std::unique_ptr<spvc_set_s> ptr(new (std::nothrow) spvc_set_s);
@@ -1837,6 +1932,7 @@ spvc_result spvc_compiler_get_active_interface_variables(spvc_compiler compiler,
 
 spvc_result spvc_compiler_set_enabled_interface_variables(spvc_compiler compiler, spvc_set set)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		compiler->compiler->set_enabled_interface_variables(set->set);
@@ -1848,6 +1944,7 @@ spvc_result spvc_compiler_set_enabled_interface_variables(spvc_compiler compiler
 spvc_result spvc_compiler_create_shader_resources_for_active_variables(spvc_compiler compiler, spvc_resources *resources,
                                                                        spvc_set set)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		std::unique_ptr<spvc_resources_s> res(new (std::nothrow) spvc_resources_s);
@@ -1874,6 +1971,7 @@ spvc_result spvc_compiler_create_shader_resources_for_active_variables(spvc_comp
 
 spvc_result spvc_compiler_create_shader_resources(spvc_compiler compiler, spvc_resources *resources)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		std::unique_ptr<spvc_resources_s> res(new (std::nothrow) spvc_resources_s);
@@ -1903,6 +2001,7 @@ spvc_result spvc_resources_get_resource_list_for_type(spvc_resources resources,
                                                       const spvc_reflected_resource **resource_list,
                                                       size_t *resource_size)
 {
+	SPVC_ALLOCATION_SCOPE(resources->context);
 	const SmallVector<spvc_reflected_resource> *list = nullptr;
 	switch (type)
 	{
@@ -1978,6 +2077,7 @@ spvc_result spvc_resources_get_builtin_resource_list_for_type(
 		const spvc_reflected_builtin_resource **resource_list,
 		size_t *resource_size)
 {
+	SPVC_ALLOCATION_SCOPE(resources->context);
 	const SmallVector<spvc_reflected_builtin_resource> *list = nullptr;
 	switch (type)
 	{
@@ -2006,46 +2106,54 @@ spvc_result spvc_resources_get_builtin_resource_list_for_type(
 
 void spvc_compiler_set_decoration(spvc_compiler compiler, SpvId id, SpvDecoration decoration, unsigned argument)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->set_decoration(id, static_cast<spv::Decoration>(decoration), argument);
 }
 
 void spvc_compiler_set_decoration_string(spvc_compiler compiler, SpvId id, SpvDecoration decoration,
                                          const char *argument)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->set_decoration_string(id, static_cast<spv::Decoration>(decoration), argument);
 }
 
 void spvc_compiler_set_name(spvc_compiler compiler, SpvId id, const char *argument)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->set_name(id, argument);
 }
 
 void spvc_compiler_set_member_decoration(spvc_compiler compiler, spvc_type_id id, unsigned member_index,
                                          SpvDecoration decoration, unsigned argument)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->set_member_decoration(id, member_index, static_cast<spv::Decoration>(decoration), argument);
 }
 
 void spvc_compiler_set_member_decoration_string(spvc_compiler compiler, spvc_type_id id, unsigned member_index,
                                                 SpvDecoration decoration, const char *argument)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->set_member_decoration_string(id, member_index, static_cast<spv::Decoration>(decoration),
 	                                                 argument);
 }
 
 void spvc_compiler_set_member_name(spvc_compiler compiler, spvc_type_id id, unsigned member_index, const char *argument)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->set_member_name(id, member_index, argument);
 }
 
 void spvc_compiler_unset_decoration(spvc_compiler compiler, SpvId id, SpvDecoration decoration)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->unset_decoration(id, static_cast<spv::Decoration>(decoration));
 }
 
 void spvc_compiler_unset_member_decoration(spvc_compiler compiler, spvc_type_id id, unsigned member_index,
                                            SpvDecoration decoration)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->unset_member_decoration(id, member_index, static_cast<spv::Decoration>(decoration));
 }
 
@@ -2098,6 +2206,7 @@ const char *spvc_compiler_get_member_name(spvc_compiler compiler, spvc_type_id i
 spvc_result spvc_compiler_get_entry_points(spvc_compiler compiler, const spvc_entry_point **entry_points,
                                            size_t *num_entry_points)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto entries = compiler->compiler->get_entry_points_and_stages();
@@ -2129,6 +2238,7 @@ spvc_result spvc_compiler_get_entry_points(spvc_compiler compiler, const spvc_en
 
 spvc_result spvc_compiler_set_entry_point(spvc_compiler compiler, const char *name, SpvExecutionModel model)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->set_entry_point(name, static_cast<spv::ExecutionModel>(model));
 	return SPVC_SUCCESS;
 }
@@ -2136,6 +2246,7 @@ spvc_result spvc_compiler_set_entry_point(spvc_compiler compiler, const char *na
 spvc_result spvc_compiler_rename_entry_point(spvc_compiler compiler, const char *old_name, const char *new_name,
                                              SpvExecutionModel model)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		compiler->compiler->rename_entry_point(old_name, new_name, static_cast<spv::ExecutionModel>(model));
@@ -2147,6 +2258,7 @@ spvc_result spvc_compiler_rename_entry_point(spvc_compiler compiler, const char
 const char *spvc_compiler_get_cleansed_entry_point_name(spvc_compiler compiler, const char *name,
                                                         SpvExecutionModel model)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto cleansed_name =
@@ -2158,6 +2270,7 @@ const char *spvc_compiler_get_cleansed_entry_point_name(spvc_compiler compiler,
 
 void spvc_compiler_set_execution_mode(spvc_compiler compiler, SpvExecutionMode mode)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->set_execution_mode(static_cast<spv::ExecutionMode>(mode));
 }
 
@@ -2165,16 +2278,19 @@ void spvc_compiler_set_execution_mode_with_arguments(spvc_compiler compiler, Spv
                                                      unsigned arg1,
                                                      unsigned arg2)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->set_execution_mode(static_cast<spv::ExecutionMode>(mode), arg0, arg1, arg2);
 }
 
 void spvc_compiler_unset_execution_mode(spvc_compiler compiler, SpvExecutionMode mode)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	compiler->compiler->unset_execution_mode(static_cast<spv::ExecutionMode>(mode));
 }
 
 spvc_result spvc_compiler_get_execution_modes(spvc_compiler compiler, const SpvExecutionMode **modes, size_t *num_modes)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto ptr = spvc_allocate<TemporaryBuffer<SpvExecutionMode>>();
@@ -2208,6 +2324,7 @@ SpvExecutionModel spvc_compiler_get_execution_model(spvc_compiler compiler)
 
 void spvc_compiler_update_active_builtins(spvc_compiler compiler)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
        compiler->compiler->update_active_builtins();
 }
 
@@ -2221,6 +2338,7 @@ spvc_bool spvc_compiler_has_active_builtin(spvc_compiler compiler, SpvBuiltIn bu
 spvc_type spvc_compiler_get_type_handle(spvc_compiler compiler, spvc_type_id id)
 {
 	// Should only throw if an intentionally garbage ID is passed, but the IDs are not type-safe.
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		return static_cast<spvc_type>(&compiler->compiler->get_type(id));
@@ -2332,6 +2450,7 @@ SpvAccessQualifier spvc_type_get_image_access_qualifier(spvc_type type)
 
 spvc_result spvc_compiler_get_declared_struct_size(spvc_compiler compiler, spvc_type struct_type, size_t *size)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		*size = compiler->compiler->get_declared_struct_size(*static_cast<const SPIRType *>(struct_type));
@@ -2343,6 +2462,7 @@ spvc_result spvc_compiler_get_declared_struct_size(spvc_compiler compiler, spvc_
 spvc_result spvc_compiler_get_declared_struct_size_runtime_array(spvc_compiler compiler, spvc_type struct_type,
                                                                  size_t array_size, size_t *size)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		*size = compiler->compiler->get_declared_struct_size_runtime_array(*static_cast<const SPIRType *>(struct_type),
@@ -2354,6 +2474,7 @@ spvc_result spvc_compiler_get_declared_struct_size_runtime_array(spvc_compiler c
 
 spvc_result spvc_compiler_get_declared_struct_member_size(spvc_compiler compiler, spvc_type struct_type, unsigned index, size_t *size)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		*size = compiler->compiler->get_declared_struct_member_size(*static_cast<const SPIRType *>(struct_type), index);
@@ -2364,6 +2485,7 @@ spvc_result spvc_compiler_get_declared_struct_member_size(spvc_compiler compiler
 
 spvc_result spvc_compiler_type_struct_member_offset(spvc_compiler compiler, spvc_type type, unsigned index, unsigned *offset)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		*offset = compiler->compiler->type_struct_member_offset(*static_cast<const SPIRType *>(type), index);
@@ -2374,6 +2496,7 @@ spvc_result spvc_compiler_type_struct_member_offset(spvc_compiler compiler, spvc
 
 spvc_result spvc_compiler_type_struct_member_array_stride(spvc_compiler compiler, spvc_type type, unsigned index, unsigned *stride)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		*stride = compiler->compiler->type_struct_member_array_stride(*static_cast<const SPIRType *>(type), index);
@@ -2384,6 +2507,7 @@ spvc_result spvc_compiler_type_struct_member_array_stride(spvc_compiler compiler
 
 spvc_result spvc_compiler_type_struct_member_matrix_stride(spvc_compiler compiler, spvc_type type, unsigned index, unsigned *stride)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		*stride = compiler->compiler->type_struct_member_matrix_stride(*static_cast<const SPIRType *>(type), index);
@@ -2394,6 +2518,7 @@ spvc_result spvc_compiler_type_struct_member_matrix_stride(spvc_compiler compile
 
 spvc_result spvc_compiler_build_dummy_sampler_for_combined_images(spvc_compiler compiler, spvc_variable_id *id)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		*id = compiler->compiler->build_dummy_sampler_for_combined_images();
@@ -2404,6 +2529,7 @@ spvc_result spvc_compiler_build_dummy_sampler_for_combined_images(spvc_compiler
 
 spvc_result spvc_compiler_build_combined_image_samplers(spvc_compiler compiler)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		compiler->compiler->build_combined_image_samplers();
@@ -2416,6 +2542,7 @@ spvc_result spvc_compiler_get_combined_image_samplers(spvc_compiler compiler,
                                                       const spvc_combined_image_sampler **samplers,
                                                       size_t *num_samplers)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto combined = compiler->compiler->get_combined_image_samplers();
@@ -2441,6 +2568,7 @@ spvc_result spvc_compiler_get_specialization_constants(spvc_compiler compiler,
                                                        const spvc_specialization_constant **constants,
                                                        size_t *num_constants)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto spec_constants = compiler->compiler->get_specialization_constants();
@@ -2464,6 +2592,7 @@ spvc_result spvc_compiler_get_specialization_constants(spvc_compiler compiler,
 
 spvc_constant spvc_compiler_get_constant_handle(spvc_compiler compiler, spvc_variable_id id)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		return static_cast<spvc_constant>(&compiler->compiler->get_constant(id));
@@ -2494,6 +2623,7 @@ spvc_result spvc_compiler_get_active_buffer_ranges(spvc_compiler compiler,
                                                    const spvc_buffer_range **ranges,
                                                    size_t *num_ranges)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto active_ranges = compiler->compiler->get_active_buffer_ranges(id);
@@ -2664,6 +2794,7 @@ spvc_result spvc_compiler_get_declared_capabilities(spvc_compiler compiler, cons
 spvc_result spvc_compiler_get_declared_extensions(spvc_compiler compiler, const char ***extensions,
                                                   size_t *num_extensions)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto &exts = compiler->compiler->get_declared_extensions();
@@ -2684,6 +2815,7 @@ spvc_result spvc_compiler_get_declared_extensions(spvc_compiler compiler, const
 
 const char *spvc_compiler_get_remapped_declared_block_name(spvc_compiler compiler, spvc_variable_id id)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto name = compiler->compiler->get_remapped_declared_block_name(id);
@@ -2695,6 +2827,7 @@ const char *spvc_compiler_get_remapped_declared_block_name(spvc_compiler compile
 spvc_result spvc_compiler_get_buffer_block_decorations(spvc_compiler compiler, spvc_variable_id id,
                                                        const SpvDecoration **decorations, size_t *num_decorations)
 {
+	SPVC_ALLOCATION_SCOPE(compiler->context);
 	SPVC_BEGIN_SAFE_SCOPE
 	{
 		auto flags = compiler->compiler->get_buffer_block_flags(id);
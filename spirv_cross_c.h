@@ -40,7 +40,7 @@ extern "C" {
 /* Bumped if ABI or API breaks backwards compatibility. */
 #define SPVC_C_API_VERSION_MAJOR 0
 /* Bumped if APIs or enumerations are added in a backwards compatible way. */
-#define SPVC_C_API_VERSION_MINOR 57
+#define SPVC_C_API_VERSION_MINOR 66
 /* Bumped if internal implementation details change. */
 #define SPVC_C_API_VERSION_PATCH 0
 
@@ -726,6 +726,20 @@ typedef enum spvc_compiler_option
 	SPVC_COMPILER_OPTION_MSL_ARGUMENT_BUFFERS_TIER = 84 | SPVC_COMPILER_OPTION_MSL_BIT,
 	SPVC_COMPILER_OPTION_MSL_SAMPLE_DREF_LOD_ARRAY_AS_GRAD = 85 | SPVC_COMPILER_OPTION_MSL_BIT,
 
+	SPVC_COMPILER_OPTION_MATERIALIZE_REUSED_EXPRESSIONS = 86 | SPVC_COMPILER_OPTION_COMMON_BIT,
+
+	SPVC_COMPILER_OPTION_GLSL_INFER_RELAXED_PRECISION = 87 | SPVC_COMPILER_OPTION_GLSL_BIT,
+
+	SPVC_COMPILER_OPTION_MSL_MINIMIZE_PACKED_STRUCT_MEMBERS = 88 | SPVC_COMPILER_OPTION_MSL_BIT,
+
+	SPVC_COMPILER_OPTION_HOIST_LOOP_INVARIANT_LOADS = 89 | SPVC_COMPILER_OPTION_COMMON_BIT,
+
+	SPVC_COMPILER_OPTION_LOWER_CONSTANT_SWITCHES = 90 | SPVC_COMPILER_OPTION_COMMON_BIT,
+	SPVC_COMPILER_OPTION_HLSL_INFER_STRUCTURED_BUFFERS = 91 | SPVC_COMPILER_OPTION_HLSL_BIT,
+	SPVC_COMPILER_OPTION_HLSL_INFER_TYPED_BUFFERS = 92 | SPVC_COMPILER_OPTION_HLSL_BIT,
+	SPVC_COMPILER_OPTION_HLSL_ELIDE_STAGE_IO_COPIES = 93 | SPVC_COMPILER_OPTION_HLSL_BIT,
+	SPVC_COMPILER_OPTION_HLSL_CACHE_TEXTURE_QUERIES = 94 | SPVC_COMPILER_OPTION_HLSL_BIT,
+
 	SPVC_COMPILER_OPTION_INT_MAX = 0x7fffffff
 } spvc_compiler_option;
 
@@ -738,6 +752,27 @@ typedef enum spvc_compiler_option
  */
 SPVC_PUBLIC_API spvc_result spvc_context_create(spvc_context *context);
 
+/*
+ * Allocation callbacks for memory owned by the library's internal containers, object pools and string streams.
+ * allocate must return memory aligned for any fundamental type, or NULL on failure.
+ * Each context installs its callbacks while one of its functions runs on the calling thread,
+ * so using one context per thread allows per-thread arenas or memory accounting.
+ */
+typedef struct spvc_allocation_callbacks
+{
+	void *userdata;
+	void *(*allocate)(void *userdata, size_t size);
+	void (*free)(void *userdata, void *ptr);
+} spvc_allocation_callbacks;
+
+/*
+ * Like spvc_context_create, but routes allocations through the given callbacks. The callbacks struct is copied,
+ * but every allocation stores a pointer to the context's copy and is freed through it,
+ * so allocate, free and userdata must remain valid until spvc_context_destroy returns.
+ */
+SPVC_PUBLIC_API spvc_result spvc_context_create_with_allocator(const spvc_allocation_callbacks *allocator,
+                                                               spvc_context *context);
+
 /* Frees all memory allocations and objects associated with the context and its child objects. */
 SPVC_PUBLIC_API void spvc_context_destroy(spvc_context context);
 
@@ -26,6 +26,7 @@
 
 #include "spirv_cross_error_handling.hpp"
 #include <algorithm>
+#include <cstddef>
 #include <exception>
 #include <functional>
 #include <iterator>
@@ -50,6 +51,85 @@
 
 namespace SPIRV_CROSS_NAMESPACE
 {
+// Allocation callbacks used for all heap memory owned by SmallVector, ObjectPool and StringStream.
+// The callbacks are installed per thread with AllocationScope, which lets a caller give
+// each thread its own arena or account for the memory used by a compilation.
+// allocate must return memory aligned to at least alignof(max_align_t), or nullptr on failure.
+struct AllocationCallbacks
+{
+	void *userdata;
+	void *(*allocate)(void *userdata, size_t size);
+	void (*free)(void *userdata, void *ptr);
+};
+
+inline const AllocationCallbacks *&current_allocation_callbacks()
+{
+	static thread_local const AllocationCallbacks *callbacks = nullptr;
+	return callbacks;
+}
+
+// Installs callbacks for the current thread until the scope ends.
+// Scopes nest, and a null pointer restores the default malloc/free.
+class AllocationScope
+{
+public:
+	explicit AllocationScope(const AllocationCallbacks *callbacks)
+	    : previous(current_allocation_callbacks())
+	{
+		current_allocation_callbacks() = callbacks;
+	}
+
+	~AllocationScope()
+	{
+		current_allocation_callbacks() = previous;
+	}
+
+	AllocationScope(const AllocationScope &) = delete;
+	void operator=(const AllocationScope &) = delete;
+
+private:
+	const AllocationCallbacks *previous;
+};
+
+// Every allocation remembers which callbacks it came from, so memory can safely be freed
+// from outside the scope it was allocated in.
+// Since only a pointer is stored, the AllocationCallbacks object and everything it refers to
+// must outlive every object allocated while it was installed.
+struct AllocationHeader
+{
+	union
+	{
+		const AllocationCallbacks *callbacks;
+		std::max_align_t align;
+	};
+};
+
+inline void *allocate_memory(size_t size)
+{
+	auto *callbacks = current_allocation_callbacks();
+	size_t total = size + sizeof(AllocationHeader);
+	void *ptr = callbacks ? callbacks->allocate(callbacks->userdata, total) : malloc(total);
+	if (!ptr)
+		return nullptr;
+
+	auto *header = static_cast<AllocationHeader *>(ptr);
+	header->callbacks = callbacks;
+	return header + 1;
+}
+
+inline void free_memory(void *ptr)
+{
+	if (!ptr)
+		return;
+
+	auto *header = static_cast<AllocationHeader *>(ptr) - 1;
+	auto *callbacks = header->callbacks;
+	if (callbacks)
+		callbacks->free(callbacks->userdata, header);
+	else
+		free(header);
+}
+
 #ifndef SPIRV_CROSS_FORCE_STL_TYPES
 // std::aligned_storage does not support size == 0, so roll our own.
 template <typename T, size_t N>
@@ -243,7 +323,7 @@ public:
 		{
 			// Pilfer allocated pointer.
 			if (this->ptr != stack_storage.data())
-				free(this->ptr);
+				free_memory(this->ptr);
 			this->ptr = other.ptr;
 			this->buffer_size = other.buffer_size;
 			buffer_capacity = other.buffer_capacity;
@@ -293,7 +373,7 @@ public:
 	{
 		clear();
 		if (this->ptr != stack_storage.data())
-			free(this->ptr);
+			free_memory(this->ptr);
 	}
 
 	void clear() SPIRV_CROSS_NOEXCEPT
@@ -357,7 +437,7 @@ public:
 				target_capacity <<= 1u;
 
 			T *new_buffer =
-			    target_capacity > N ? static_cast<T *>(malloc(target_capacity * sizeof(T))) : stack_storage.data();
+			    target_capacity > N ? static_cast<T *>(allocate_memory(target_capacity * sizeof(T))) : stack_storage.data();
 
 			// If we actually fail this malloc, we are hosed anyways, there is no reason to attempt recovery.
 			if (!new_buffer)
@@ -375,7 +455,7 @@ public:
 			}
 
 			if (this->ptr != stack_storage.data())
-				free(this->ptr);
+				free_memory(this->ptr);
 			this->ptr = new_buffer;
 			buffer_capacity = target_capacity;
 		}
@@ -406,7 +486,7 @@ public:
 
 				// Need to allocate new buffer. Move everything to a new buffer.
 				T *new_buffer =
-				    target_capacity > N ? static_cast<T *>(malloc(target_capacity * sizeof(T))) : stack_storage.data();
+				    target_capacity > N ? static_cast<T *>(allocate_memory(target_capacity * sizeof(T))) : stack_storage.data();
 
 				// If we actually fail this malloc, we are hosed anyways, there is no reason to attempt recovery.
 				if (!new_buffer)
@@ -445,7 +525,7 @@ public:
 				}
 
 				if (this->ptr != stack_storage.data())
-					free(this->ptr);
+					free_memory(this->ptr);
 				this->ptr = new_buffer;
 				buffer_capacity = target_capacity;
 			}
@@ -525,6 +605,15 @@ public:
 		this->buffer_size = new_size;
 	}
 
+	// Like resize(), but new elements are left uninitialized, for callers which overwrite them right away.
+	// Only valid for trivially copyable types.
+	void resize_uninitialized(size_t new_size) SPIRV_CROSS_NOEXCEPT
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "resize_uninitialized() requires a trivially copyable type.");
+		reserve(new_size);
+		this->buffer_size = new_size;
+	}
+
 private:
 	size_t buffer_capacity = 0;
 	AlignedBuffer<T, N> stack_storage;
@@ -550,11 +639,15 @@ using VectorView = std::vector<T>;
 // An object pool which we use for allocating IVariant-derived objects.
 // We know we are going to allocate a bunch of objects of each type,
 // so amortize the mallocs.
+// Objects are carved out of each memory block in allocation order, so objects of one type which are
+// allocated together, e.g. while parsing, end up densely packed in ID order.
 class ObjectPoolBase
 {
 public:
 	virtual ~ObjectPoolBase() = default;
 	virtual void deallocate_opaque(void *ptr) = 0;
+	virtual void *clone_opaque(const void *ptr) = 0;
+	virtual void reserve(unsigned count) = 0;
 };
 
 template <typename T>
@@ -569,21 +662,19 @@ public:
 	template <typename... P>
 	T *allocate(P &&... p)
 	{
-		if (vacants.empty())
+		T *ptr;
+		if (!vacants.empty())
+		{
+			ptr = vacants.back();
+			vacants.pop_back();
+		}
+		else
 		{
-			unsigned num_objects = start_object_count << memory.size();
-			T *ptr = static_cast<T *>(malloc(num_objects * sizeof(T)));
-			if (!ptr)
+			if (block_used == block_size && !allocate_block(start_object_count << memory.size()))
 				return nullptr;
-
-			for (unsigned i = 0; i < num_objects; i++)
-				vacants.push_back(&ptr[i]);
-
-			memory.emplace_back(ptr);
+			ptr = memory.back().get() + block_used++;
 		}
 
-		T *ptr = vacants.back();
-		vacants.pop_back();
 		new (ptr) T(std::forward<P>(p)...);
 		return ptr;
 	}
@@ -599,25 +690,53 @@ public:
 		deallocate(static_cast<T *>(ptr));
 	}
 
+	void *clone_opaque(const void *ptr) override
+	{
+		return allocate(*static_cast<const T *>(ptr));
+	}
+
+	// Makes sure the next count allocations are served from one contiguous block.
+	void reserve(unsigned count) override
+	{
+		if (block_size - block_used < count)
+			allocate_block(std::max(count, start_object_count << memory.size()));
+	}
+
 	void clear()
 	{
 		vacants.clear();
 		memory.clear();
+		block_used = 0;
+		block_size = 0;
 	}
 
 protected:
 	Vector<T *> vacants;
 
-	struct MallocDeleter
+	struct MemoryDeleter
 	{
 		void operator()(T *ptr)
 		{
-			::free(ptr);
+			free_memory(ptr);
 		}
 	};
 
-	SmallVector<std::unique_ptr<T, MallocDeleter>> memory;
+	SmallVector<std::unique_ptr<T, MemoryDeleter>> memory;
 	unsigned start_object_count;
+	unsigned block_used = 0;
+	unsigned block_size = 0;
+
+	bool allocate_block(unsigned num_objects)
+	{
+		T *ptr = static_cast<T *>(allocate_memory(num_objects * sizeof(T)));
+		if (!ptr)
+			return false;
+
+		memory.emplace_back(ptr);
+		block_used = 0;
+		block_size = num_objects;
+		return true;
+	}
 };
 
 template <size_t StackSize = 4096, size_t BlockSize = 4096>
@@ -698,9 +817,9 @@ public:
 	{
 		for (auto &saved : saved_buffers)
 			if (saved.buffer != stack_buffer)
-				free(saved.buffer);
+				free_memory(saved.buffer);
 		if (current_buffer.buffer != stack_buffer)
-			free(current_buffer.buffer);
+			free_memory(current_buffer.buffer);
 
 		saved_buffers.clear();
 		current_buffer.buffer = stack_buffer;
@@ -734,7 +853,7 @@ private:
 
 			saved_buffers.push_back(current_buffer);
 			size_t target_size = len > BlockSize ? len : BlockSize;
-			current_buffer.buffer = static_cast<char *>(malloc(target_size));
+			current_buffer.buffer = static_cast<char *>(allocate_memory(target_size));
 			if (!current_buffer.buffer)
 				SPIRV_CROSS_THROW("Out of memory.");
 
@@ -61,6 +61,8 @@ ParsedIR &ParsedIR::operator=(ParsedIR &&other) SPIRV_CROSS_NOEXCEPT
 {
 	if (this != &other)
 	{
+		// Our variants hold pointers into the current pool group, release them before it goes away.
+		ids.clear();
 		pool_group = std::move(other.pool_group);
 		spirv = std::move(other.spirv);
 		meta = std::move(other.meta);
@@ -124,6 +126,15 @@ ParsedIR &ParsedIR::operator=(const ParsedIR &other)
 		// Construct object first so we have the correct allocator set-up, then we can copy object into our new pool group.
 		ids.clear();
 		ids.reserve(other.ids.size());
+
+		// Size each pool up front so the copied objects of a type land in one block, in ID order.
+		uint32_t type_counts[TypeCount] = {};
+		for (auto &id : other.ids)
+			type_counts[id.get_type()]++;
+		for (int i = 0; i < TypeCount; i++)
+			if (type_counts[i] && pool_group->pools[i])
+				pool_group->pools[i]->reserve(type_counts[i]);
+
 		for (size_t i = 0; i < other.ids.size(); i++)
 		{
 			ids.emplace_back(pool_group.get());
@@ -456,6 +456,7 @@ void CompilerGLSL::find_static_extensions()
 		}
 		break;
 
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	case ExecutionModelTessellationEvaluation:
 	case ExecutionModelTessellationControl:
 		if (options.es && options.version < 320)
@@ -463,6 +464,7 @@ void CompilerGLSL::find_static_extensions()
 		if (!options.es && options.version < 400)
 			require_extension_internal("GL_ARB_tessellation_shader");
 		break;
+#endif // SPIRV_CROSS_NO_TESSELLATION
 
 	case ExecutionModelRayGenerationKHR:
 	case ExecutionModelIntersectionKHR:
@@ -665,6 +667,11 @@ void CompilerGLSL::ray_tracing_khr_fixup_locations()
 string CompilerGLSL::compile()
 {
 	ir.fixup_reserved_names();
+	validate_compiled_features();
+#ifdef SPIRV_CROSS_NO_LEGACY_TARGETS
+	if (is_legacy())
+		SPIRV_CROSS_THROW("Legacy GLSL and ESSL targets were compiled out (SPIRV_CROSS_NO_LEGACY_TARGETS).");
+#endif
 
 	if (!options.vulkan_semantics)
 	{
@@ -688,7 +695,22 @@ string CompilerGLSL::compile()
 	fixup_anonymous_struct_names();
 	fixup_type_alias();
 	reorder_type_alias();
+	restore_loop_invariant_loads();
+	if (options.hoist_loop_invariant_loads)
+		hoist_loop_invariant_loads();
 	build_function_control_flow_graphs_and_analyze();
+	if (options.materialize_reused_expressions)
+		analyze_expression_reuse(temporary_to_mirror_precision_alias);
+	else
+		reset_expression_reuse();
+	if (options.lower_constant_switches)
+		analyze_constant_switches(!is_legacy());
+	else
+		reset_constant_switches();
+	if (options.infer_relaxed_precision && backend.requires_relaxed_precision_analysis)
+		analyze_relaxed_precision_dataflow();
+	else
+		reset_relaxed_precision_dataflow();
 	find_static_extensions();
 	fixup_image_load_store_access();
 	update_active_builtins();
@@ -1054,6 +1076,7 @@ void CompilerGLSL::emit_header()
 		}
 		break;
 
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	case ExecutionModelTessellationControl:
 		if (execution.flags.get(ExecutionModeOutputVertices))
 			outputs.push_back(join("vertices = ", execution.output_vertices));
@@ -1084,6 +1107,7 @@ void CompilerGLSL::emit_header()
 		if (execution.flags.get(ExecutionModeSpacingEqual))
 			inputs.push_back("equal_spacing");
 		break;
+#endif // SPIRV_CROSS_NO_TESSELLATION
 
 	case ExecutionModelGLCompute:
 	case ExecutionModelTaskEXT:
@@ -2275,13 +2299,19 @@ void CompilerGLSL::emit_buffer_block(const SPIRVariable &var)
 
 	if (flattened_buffer_blocks.count(var.self))
 		emit_buffer_block_flattened(var);
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 	else if (is_legacy() || (!options.es && options.version == 130) ||
 	         (ubo_block && options.emit_uniform_buffer_as_plain_uniforms))
 		emit_buffer_block_legacy(var);
+#else
+	else if ((!options.es && options.version == 130) || (ubo_block && options.emit_uniform_buffer_as_plain_uniforms))
+		SPIRV_CROSS_THROW("Plain uniform buffer emission was compiled out (SPIRV_CROSS_NO_LEGACY_TARGETS).");
+#endif
 	else
 		emit_buffer_block_native(var);
 }
 
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 void CompilerGLSL::emit_buffer_block_legacy(const SPIRVariable &var)
 {
 	auto &type = get<SPIRType>(var.basetype);
@@ -2301,6 +2331,7 @@ void CompilerGLSL::emit_buffer_block_legacy(const SPIRVariable &var)
 	emit_uniform(var);
 	statement("");
 }
+#endif // SPIRV_CROSS_NO_LEGACY_TARGETS
 
 void CompilerGLSL::emit_buffer_reference_block(uint32_t type_id, bool forward_declaration)
 {
@@ -2483,20 +2514,32 @@ void CompilerGLSL::emit_buffer_block_flattened(const SPIRVariable &var)
 	size_t buffer_size = (get_declared_struct_size(type) + 15) / 16;
 
 	SPIRType::BaseType basic_type;
-	if (get_common_basic_type(type, basic_type))
-	{
-		SPIRType tmp;
-		tmp.basetype = basic_type;
-		tmp.vecsize = 4;
-		if (basic_type != SPIRType::Float && basic_type != SPIRType::Int && basic_type != SPIRType::UInt)
-			SPIRV_CROSS_THROW("Basic types in a flattened UBO must be float, int or uint.");
+	bool mixed_types = !get_common_basic_type(type, basic_type);
+	if (mixed_types)
+		basic_type = SPIRType::Float;
 
-		auto flags = ir.get_buffer_block_flags(var);
-		statement("uniform ", flags_to_qualifiers_glsl(tmp, flags), type_to_glsl(tmp), " ", buffer_name, "[",
-		          buffer_size, "];");
-	}
+	SPIRType tmp;
+	tmp.basetype = basic_type;
+	tmp.vecsize = 4;
+	if (basic_type != SPIRType::Float && basic_type != SPIRType::Int && basic_type != SPIRType::UInt)
+		SPIRV_CROSS_THROW("Basic types in a flattened UBO must be float, int or uint.");
+
+	auto flags = ir.get_buffer_block_flags(var);
+	// Integer members are stored in the float components of mixed blocks, which must not lose any bits.
+	if (mixed_types)
+		flags.clear(DecorationRelaxedPrecision);
+
+	statement("uniform ", flags_to_qualifiers_glsl(tmp, flags), type_to_glsl(tmp), " ", buffer_name, "[", buffer_size,
+	          "];");
+}
+
+SPIRType::BaseType CompilerGLSL::flattened_buffer_block_basic_type(const SPIRType &type)
+{
+	SPIRType::BaseType basic_type;
+	if (get_common_basic_type(type, basic_type))
+		return basic_type;
 	else
-		SPIRV_CROSS_THROW("All basic types in a flattened block must be the same.");
+		return SPIRType::Float;
 }
 
 const char *CompilerGLSL::to_storage_qualifiers_glsl(const SPIRVariable &var)
@@ -2762,6 +2805,7 @@ void CompilerGLSL::emit_interface_block(const SPIRVariable &var)
 			if (is_legacy() && var.storage == StorageClassInput && type.basetype == SPIRType::Int)
 				newtype.basetype = SPIRType::Float;
 
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 			// Tessellation control and evaluation shaders must have either
 			// gl_MaxPatchVertices or unsized arrays for input arrays.
 			// Opt for unsized as it's the more "correct" variant to use.
@@ -2773,6 +2817,7 @@ void CompilerGLSL::emit_interface_block(const SPIRVariable &var)
 				newtype.array.back() = 0;
 				newtype.array_size_literal.back() = true;
 			}
+#endif
 
 			statement(layout_for_variable(var), to_qualifiers_glsl(var.self),
 			          variable_decl(newtype, to_name(var.self), var.self), ";");
@@ -3462,9 +3507,11 @@ void CompilerGLSL::emit_declared_builtin_block(StorageClass storage, ExecutionMo
 		else
 			instance_name = storage == StorageClassInput ? "gl_in" : "gl_out";
 
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 		if (model == ExecutionModelTessellationControl && storage == StorageClassOutput)
 			end_scope_decl(join(instance_name, "[", get_entry_point().output_vertices, "]"));
 		else
+#endif
 			end_scope_decl(join(instance_name, "[]"));
 	}
 	else
@@ -3504,8 +3551,10 @@ void CompilerGLSL::emit_resources()
 	switch (execution.model)
 	{
 	case ExecutionModelGeometry:
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	case ExecutionModelTessellationControl:
 	case ExecutionModelTessellationEvaluation:
+#endif
 	case ExecutionModelMeshEXT:
 		fixup_implicit_builtin_block_names(execution.model);
 		break;
@@ -3522,8 +3571,10 @@ void CompilerGLSL::emit_resources()
 		switch (execution.model)
 		{
 		case ExecutionModelGeometry:
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 		case ExecutionModelTessellationControl:
 		case ExecutionModelTessellationEvaluation:
+#endif
 			emit_declared_builtin_block(StorageClassInput, execution.model);
 			emit_declared_builtin_block(StorageClassOutput, execution.model);
 			global_invariant_position = false;
@@ -3871,7 +3922,13 @@ void CompilerGLSL::emit_output_variable_initializer(const SPIRVariable &var)
 	auto &type = get<SPIRType>(var.basetype);
 	bool is_patch = has_decoration(var.self, DecorationPatch);
 	bool is_block = has_decoration(type.self, DecorationBlock);
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	bool is_control_point = get_execution_model() == ExecutionModelTessellationControl && !is_patch;
+#else
+	// Only tessellation control shaders have per control point outputs.
+	bool is_control_point = false;
+	(void)is_patch;
+#endif
 
 	if (is_block)
 	{
@@ -7091,6 +7148,7 @@ void CompilerGLSL::emit_bitfield_insert_op(uint32_t result_type, uint32_t result
 	inherit_expression_dependencies(result_id, op3);
 }
 
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 string CompilerGLSL::legacy_tex_op(const std::string &op, const SPIRType &imgtype, uint32_t tex)
 {
 	const char *type;
@@ -7206,6 +7264,7 @@ string CompilerGLSL::legacy_tex_op(const std::string &op, const SPIRType &imgtyp
 		SPIRV_CROSS_THROW(join("Unsupported legacy texture op: ", op));
 	}
 }
+#endif // SPIRV_CROSS_NO_LEGACY_TARGETS
 
 bool CompilerGLSL::to_trivial_mix_op(const SPIRType &type, string &op, uint32_t left, uint32_t right, uint32_t lerp)
 {
@@ -7933,7 +7992,13 @@ string CompilerGLSL::to_function_name(const TextureFunctionNameArguments &args)
 	if (args.is_sparse_feedback || args.has_min_lod)
 		fname += "ARB";
 
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 	return (is_legacy() && !args.base.is_gather) ? legacy_tex_op(fname, imgtype, tex) : fname;
+#else
+	(void)imgtype;
+	(void)tex;
+	return fname;
+#endif
 }
 
 std::string CompilerGLSL::convert_separate_image_to_expression(uint32_t id)
@@ -8906,6 +8971,7 @@ void CompilerGLSL::emit_emulated_ahyper_op(uint32_t result_type, uint32_t id, ui
 	inherit_expression_dependencies(id, op0);
 }
 
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 void CompilerGLSL::emit_spv_amd_shader_ballot_op(uint32_t result_type, uint32_t id, uint32_t eop, const uint32_t *args,
                                                  uint32_t)
 {
@@ -9054,6 +9120,28 @@ void CompilerGLSL::emit_spv_amd_gcn_shader_op(uint32_t result_type, uint32_t id,
 		break;
 	}
 }
+#else
+void CompilerGLSL::emit_spv_amd_shader_ballot_op(uint32_t, uint32_t, uint32_t, const uint32_t *, uint32_t)
+{
+	SPIRV_CROSS_THROW("AMD extension support was compiled out (SPIRV_CROSS_NO_AMD_EXTENSIONS).");
+}
+
+void CompilerGLSL::emit_spv_amd_shader_explicit_vertex_parameter_op(uint32_t, uint32_t, uint32_t, const uint32_t *,
+                                                                    uint32_t)
+{
+	SPIRV_CROSS_THROW("AMD extension support was compiled out (SPIRV_CROSS_NO_AMD_EXTENSIONS).");
+}
+
+void CompilerGLSL::emit_spv_amd_shader_trinary_minmax_op(uint32_t, uint32_t, uint32_t, const uint32_t *, uint32_t)
+{
+	SPIRV_CROSS_THROW("AMD extension support was compiled out (SPIRV_CROSS_NO_AMD_EXTENSIONS).");
+}
+
+void CompilerGLSL::emit_spv_amd_gcn_shader_op(uint32_t, uint32_t, uint32_t, const uint32_t *, uint32_t)
+{
+	SPIRV_CROSS_THROW("AMD extension support was compiled out (SPIRV_CROSS_NO_AMD_EXTENSIONS).");
+}
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 
 void CompilerGLSL::emit_subgroup_op(const Instruction &i)
 {
@@ -9585,12 +9673,14 @@ string CompilerGLSL::builtin_to_glsl(BuiltIn builtin, StorageClass storage)
 		return "gl_Layer";
 	case BuiltInViewportIndex:
 		return "gl_ViewportIndex";
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	case BuiltInTessLevelOuter:
 		return "gl_TessLevelOuter";
 	case BuiltInTessLevelInner:
 		return "gl_TessLevelInner";
 	case BuiltInTessCoord:
 		return "gl_TessCoord";
+#endif
 	case BuiltInFragCoord:
 		return "gl_FragCoord";
 	case BuiltInPointCoord:
@@ -10273,6 +10363,7 @@ string CompilerGLSL::access_chain_internal(uint32_t base, const uint32_t *indice
 				// to consider scalar access chains here.
 				// Cleans up some cases where it's very painful to determine the accurate storage class
 				// since blocks can be partially masked ...
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 				auto *var = maybe_get_backing_variable(base);
 				if (var && var->storage == StorageClassOutput &&
 				    get_execution_model() == ExecutionModelTessellationControl &&
@@ -10280,6 +10371,7 @@ string CompilerGLSL::access_chain_internal(uint32_t base, const uint32_t *indice
 				{
 					ignore_potential_sliced_writes = true;
 				}
+#endif
 			}
 			else
 				ignore_potential_sliced_writes = true;
@@ -10677,6 +10769,27 @@ std::string CompilerGLSL::flattened_access_chain_vector(uint32_t base, const uin
 
 		expr += vector_swizzle(target_type.vecsize, index % 4);
 
+		// Blocks which mix basic types are declared as vec4 arrays, so integer members have to be reinterpreted.
+		auto storage_basetype = flattened_buffer_block_basic_type(expression_type(base));
+		if (target_type.basetype != storage_basetype)
+		{
+			auto &value_type = get_pointee_type(target_type);
+			if ((value_type.basetype != SPIRType::Int && value_type.basetype != SPIRType::UInt) ||
+			    value_type.width != 32)
+				SPIRV_CROSS_THROW("Basic types in a flattened UBO must be float, int or uint.");
+
+			// Legacy ESSL has no bitcasts. The application has to upload such members as float values instead,
+			// which represents integers exactly up to 2^24.
+			if (is_legacy_es())
+				expr = join(type_to_glsl_constructor(value_type), "(", expr, ")");
+			else
+			{
+				SPIRType storage_type = value_type;
+				storage_type.basetype = storage_basetype;
+				expr = join(bitcast_glsl_op(value_type, storage_type), "(", expr, ")");
+			}
+		}
+
 		return expr;
 	}
 }
@@ -10978,7 +11091,9 @@ void CompilerGLSL::track_expression_read(uint32_t id)
 
 	// If we try to read a forwarded temporary more than once we will stamp out possibly complex code twice.
 	// In this case, it's better to just bind the complex expression to the temporary and read that temporary twice.
-	if (expression_is_forwarded(id) && !expression_suppresses_usage_tracking(id))
+	// Expressions which analyze_expression_reuse() deemed trivial are duplicated on purpose.
+	if (expression_is_forwarded(id) && !expression_suppresses_usage_tracking(id) &&
+	    duplicated_expressions.count(id) == 0)
 	{
 		auto &v = expression_usage_counts[id];
 		v++;
@@ -11538,8 +11653,13 @@ void CompilerGLSL::forward_relaxed_precision(uint32_t dst_id, const uint32_t *ar
 
 	// For expressions which are loaded or directly forwarded, we inherit mediump implicitly.
 	// For dst_id to be analyzed properly, it must inherit any relaxed precision decoration from src_id.
-	if (input_precision == Options::Mediump)
+	if (input_precision == Options::Mediump && !has_decoration(dst_id, DecorationRelaxedPrecision))
+	{
 		set_decoration(dst_id, DecorationRelaxedPrecision);
+		// The inputs may be mediump only because of analyze_relaxed_precision_dataflow().
+		if (options.infer_relaxed_precision)
+			forwarded_relaxed_precision.push_back(dst_id);
+	}
 }
 
 CompilerGLSL::Options::Precision CompilerGLSL::analyze_expression_precision(const uint32_t *args, uint32_t length) const
@@ -11755,6 +11875,245 @@ CompilerGLSL::TemporaryCopy CompilerGLSL::handle_instruction_precision(const Ins
 	return {};
 }
 
+void CompilerGLSL::reset_relaxed_precision_dataflow()
+{
+	// Inferred precision must not leak into a later compile() or into reflection,
+	// so undo every decoration and temporary from the last inference.
+	for (auto id : inferred_relaxed_precision)
+		unset_decoration(id, DecorationRelaxedPrecision);
+	for (auto id : forwarded_relaxed_precision)
+		unset_decoration(id, DecorationRelaxedPrecision);
+	inferred_relaxed_precision.clear();
+	forwarded_relaxed_precision.clear();
+
+	for (auto id : inferred_precision_temporaries)
+		forced_temporaries.erase(id);
+	inferred_precision_temporaries.clear();
+}
+
+void CompilerGLSL::analyze_relaxed_precision_dataflow()
+{
+	reset_relaxed_precision_dataflow();
+
+	// handle_instruction_precision() only sees one instruction at a time, in emission order.
+	// Any mismatch it finds is resolved by mirroring a temporary into the other precision,
+	// and PHI variables never inherit mediump from their incoming values.
+	// Here we propagate precision through the entire module until we reach a fixed point.
+	// Operations which do arithmetic keep the precision SPIR-V declares for them,
+	// but values which are just moved around can be mediump if either
+	// - every non-constant input is mediump, so nothing is lost, or
+	// - every consumer is a RelaxedPrecision operation, which would truncate the value anyway.
+	// PHI variables only use the latter rule, since a mediump PHI consumed in highp would need a mirror copy.
+	struct Candidate
+	{
+		uint32_t id;
+		uint32_t type;
+		const uint32_t *args;
+		uint32_t length;
+	};
+	SmallVector<Candidate> candidates;
+	std::unordered_set<uint32_t> phi_variables;
+	// Tracks how each value is consumed.
+	enum
+	{
+		HighpConsumer = 1 << 0,
+		MediumpConsumer = 1 << 1,
+		MediumpOperationConsumer = 1 << 2
+	};
+	std::unordered_map<uint32_t, uint32_t> consumers;
+
+	const auto is_relaxable_type = [&](uint32_t type_id) -> bool {
+		auto &type = get<SPIRType>(type_id);
+		return (type.basetype == SPIRType::Float || type.basetype == SPIRType::Int ||
+		        type.basetype == SPIRType::UInt) &&
+		       type.width == 32;
+	};
+
+	ir.for_each_typed_id<SPIRFunction>([&](uint32_t, const SPIRFunction &func) {
+		for (auto block_id : func.blocks)
+		{
+			auto &block = get<SPIRBlock>(block_id);
+			for (auto &phi : block.phi_variables)
+				if (is_relaxable_type(get<SPIRVariable>(phi.function_variable).basetype))
+					phi_variables.insert(phi.function_variable);
+
+			for (auto &i : block.ops)
+			{
+				auto *ops = stream(i);
+				auto op = static_cast<Op>(i.op);
+				if (i.length <= 2)
+					continue;
+
+				uint32_t forwarding_length = i.length - 2;
+				if (opcode_is_precision_forwarding_instruction(op, forwarding_length) && is_relaxable_type(ops[0]))
+					candidates.push_back({ ops[1], ops[0], &ops[2], forwarding_length });
+			}
+		}
+	});
+
+	const auto register_consumer = [&](uint32_t id, uint32_t kind) { consumers[id] |= kind; };
+
+	// Only bother if it saves us a mirror copy, i.e. some arithmetic actually consumes the value in mediump.
+	const auto mediump_consumers_only = [&](uint32_t id) -> bool {
+		auto itr = consumers.find(id);
+		return itr != end(consumers) && (itr->second & HighpConsumer) == 0 &&
+		       (itr->second & MediumpOperationConsumer) != 0;
+	};
+
+	bool changed;
+	do
+	{
+		changed = false;
+
+		// Forward propagation. Moving mediump values around cannot lose any precision.
+		for (auto &candidate : candidates)
+		{
+			if (!has_decoration(candidate.id, DecorationRelaxedPrecision) &&
+			    analyze_expression_precision(candidate.args, candidate.length) == Options::Mediump)
+			{
+				set_decoration(candidate.id, DecorationRelaxedPrecision);
+				inferred_relaxed_precision.push_back(candidate.id);
+				changed = true;
+			}
+		}
+
+		// Backward propagation. Find every value which is only ever consumed in mediump contexts.
+		consumers.clear();
+		ir.for_each_typed_id<SPIRFunction>([&](uint32_t, const SPIRFunction &func) {
+			for (auto block_id : func.blocks)
+			{
+				auto &block = get<SPIRBlock>(block_id);
+				for (auto &phi : block.phi_variables)
+					register_consumer(phi.local_variable, has_decoration(phi.function_variable, DecorationRelaxedPrecision) ?
+					                                          MediumpConsumer : HighpConsumer);
+
+				for (auto &i : block.ops)
+				{
+					auto *ops = stream(i);
+					auto op = static_cast<Op>(i.op);
+					uint32_t mediump_begin = 0;
+					uint32_t mediump_end = 0;
+					uint32_t mediump_kind = MediumpConsumer;
+
+					if (op == OpStore && i.length >= 2)
+					{
+						auto *var = maybe_get_backing_variable(ops[0]);
+						if (has_decoration(ops[0], DecorationRelaxedPrecision) ||
+						    (var && has_decoration(var->self, DecorationRelaxedPrecision)))
+						{
+							mediump_begin = 1;
+							mediump_end = 2;
+						}
+					}
+					else if (i.length > 2 && has_decoration(ops[1], DecorationRelaxedPrecision))
+					{
+						uint32_t forwarding_length = i.length - 2;
+						if (opcode_is_precision_sensitive_operation(op))
+						{
+							mediump_begin = 2;
+							mediump_end = i.length;
+							mediump_kind = MediumpOperationConsumer;
+						}
+						else if (op == OpExtInst && i.length >= 5 && get<SPIRExtension>(ops[2]).ext == SPIRExtension::GLSL)
+						{
+							mediump_begin = 4;
+							mediump_end = i.length;
+							mediump_kind = MediumpOperationConsumer;
+						}
+						else if (opcode_is_precision_forwarding_instruction(op, forwarding_length))
+						{
+							mediump_begin = 2;
+							mediump_end = std::min<uint32_t>(i.length, forwarding_length + 2);
+						}
+					}
+
+					bool has_result = false, has_result_type = false;
+					HasResultAndType(op, &has_result, &has_result_type);
+					uint32_t first_operand = has_result_type ? 2 : (has_result ? 1 : 0);
+
+					// Literals might alias any ID, but that can only make us more conservative.
+					for (uint32_t arg = first_operand; arg < i.length; arg++)
+					{
+						bool mediump_operand = arg >= mediump_begin && arg < mediump_end;
+						register_consumer(ops[arg], mediump_operand ? mediump_kind : uint32_t(HighpConsumer));
+					}
+				}
+
+				if (block.return_value)
+					register_consumer(block.return_value, HighpConsumer);
+				if (block.condition)
+					register_consumer(block.condition, HighpConsumer);
+			}
+		});
+
+		for (auto &candidate : candidates)
+		{
+			if (has_decoration(candidate.id, DecorationRelaxedPrecision) || get<SPIRType>(candidate.type).pointer)
+				continue;
+			if (!mediump_consumers_only(candidate.id))
+				continue;
+			// Constant expressions have no inherent precision, they'll be evaluated in mediump either way.
+			if (analyze_expression_precision(candidate.args, candidate.length) == Options::DontCare)
+				continue;
+
+			// The value must be bound to a mediump temporary, or it would be evaluated in highp at every use.
+			set_decoration(candidate.id, DecorationRelaxedPrecision);
+			inferred_relaxed_precision.push_back(candidate.id);
+			if (forced_temporaries.insert(candidate.id).second)
+				inferred_precision_temporaries.push_back(candidate.id);
+			changed = true;
+		}
+
+		for (auto phi : phi_variables)
+		{
+			if (has_decoration(phi, DecorationRelaxedPrecision))
+				continue;
+			if (!mediump_consumers_only(phi))
+				continue;
+
+			set_decoration(phi, DecorationRelaxedPrecision);
+			inferred_relaxed_precision.push_back(phi);
+			changed = true;
+		}
+	} while (changed);
+}
+
+CompilerGLSL::PrecisionReport CompilerGLSL::get_precision_report() const
+{
+	PrecisionReport report;
+
+	ir.for_each_typed_id<SPIRFunction>([&](uint32_t, const SPIRFunction &func) {
+		for (auto block_id : func.blocks)
+		{
+			for (auto &i : get<SPIRBlock>(block_id).ops)
+			{
+				auto *ops = stream(i);
+				auto op = static_cast<Op>(i.op);
+				if (i.length < 3)
+					continue;
+
+				if (!opcode_is_precision_sensitive_operation(op) &&
+				    !(op == OpExtInst && get<SPIRExtension>(ops[2]).ext == SPIRExtension::GLSL))
+					continue;
+
+				auto &type = get<SPIRType>(ops[0]);
+				if (type.basetype != SPIRType::Float && type.basetype != SPIRType::Int &&
+				    type.basetype != SPIRType::UInt)
+					continue;
+
+				if (has_decoration(ops[1], DecorationRelaxedPrecision))
+					report.mediump_operations++;
+				else
+					report.highp_operations++;
+			}
+		}
+	});
+
+	report.precision_copies = uint32_t(temporary_to_mirror_precision_alias.size());
+	report.inferred_mediump_values = uint32_t(inferred_relaxed_precision.size());
+	return report;
+}
+
 void CompilerGLSL::emit_instruction(const Instruction &instruction)
 {
 	auto ops = stream(instruction);
@@ -13743,12 +14102,14 @@ void CompilerGLSL::emit_instruction(const Instruction &instruction)
 		uint32_t id = ops[1];
 		uint32_t img = ops[2];
 		auto &type = expression_type(img);
-		auto &imgtype = get<SPIRType>(type.self);
 
 		std::string fname = "textureSize";
 		if (is_legacy_desktop())
 		{
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
+			auto &imgtype = get<SPIRType>(type.self);
 			fname = legacy_tex_op(fname, imgtype, img);
+#endif
 		}
 		else if (is_legacy_es())
 			SPIRV_CROSS_THROW("textureSize is not supported in ESSL 100.");
@@ -14035,11 +14396,13 @@ void CompilerGLSL::emit_instruction(const Instruction &instruction)
 			{
 				// This path is hit for samplerBuffers and multisampled images which do not have LOD.
 				std::string fname = "textureSize";
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 				if (is_legacy())
 				{
 					auto &imgtype = get<SPIRType>(type.self);
 					fname = legacy_tex_op(fname, imgtype, ops[2]);
 				}
+#endif
 				expr = join(fname, "(", convert_separate_image_to_expression(ops[2]), ")");
 			}
 
@@ -14085,6 +14448,7 @@ void CompilerGLSL::emit_instruction(const Instruction &instruction)
 			}
 		}
 
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 		if (execution_scope != ScopeSubgroup && get_entry_point().model == ExecutionModelTessellationControl)
 		{
 			// Control shaders only have barriers, and it implies memory barriers.
@@ -14092,6 +14456,7 @@ void CompilerGLSL::emit_instruction(const Instruction &instruction)
 				statement("barrier();");
 			break;
 		}
+#endif
 
 		// We only care about these flags, acquire/release and friends are not relevant to GLSL.
 		semantics = mask_relevant_memory_semantics(semantics);
@@ -14228,6 +14593,7 @@ void CompilerGLSL::emit_instruction(const Instruction &instruction)
 		{
 			emit_glsl_op(ops[0], ops[1], ops[3], &ops[4], length - 4);
 		}
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 		else if (ext == SPIRExtension::SPV_AMD_shader_ballot)
 		{
 			emit_spv_amd_shader_ballot_op(ops[0], ops[1], ops[3], &ops[4], length - 4);
@@ -14244,6 +14610,7 @@ void CompilerGLSL::emit_instruction(const Instruction &instruction)
 		{
 			emit_spv_amd_gcn_shader_op(ops[0], ops[1], ops[3], &ops[4], length - 4);
 		}
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 		else if (ext == SPIRExtension::SPV_debug_info ||
 		         ext == SPIRExtension::NonSemanticShaderDebugInfo ||
 		         ext == SPIRExtension::NonSemanticGeneric)
@@ -14546,6 +14913,7 @@ void CompilerGLSL::emit_instruction(const Instruction &instruction)
 		break;
 	}
 
+#ifndef SPIRV_CROSS_NO_RAY_TRACING
 	case OpReportIntersectionKHR:
 		// NV is same opcode.
 		forced_temporaries.insert(ops[1]);
@@ -14673,6 +15041,7 @@ void CompilerGLSL::emit_instruction(const Instruction &instruction)
 		}
 		break;
 	}
+#endif // SPIRV_CROSS_NO_RAY_TRACING
 
 	case OpConvertUToPtr:
 	{
@@ -14753,9 +15122,11 @@ void CompilerGLSL::emit_instruction(const Instruction &instruction)
 		}
 		break;
 
+#ifndef SPIRV_CROSS_NO_MESH_SHADING
 	case OpSetMeshOutputsEXT:
 		statement("SetMeshOutputsEXT(", to_unpacked_expression(ops[0]), ", ", to_unpacked_expression(ops[1]), ");");
 		break;
+#endif // SPIRV_CROSS_NO_MESH_SHADING
 
 	case OpReadClockKHR:
 	{
@@ -16727,6 +17098,74 @@ void CompilerGLSL::emit_hoisted_temporaries(SmallVector<pair<TypeID, ID>> &tempo
 	}
 }
 
+bool CompilerGLSL::emit_constant_switch(const SPIRBlock &block)
+{
+	auto itr = constant_switches.find(block.self);
+	if (itr == end(constant_switches))
+		return false;
+
+	auto &constant_switch = itr->second;
+	bool unsigned_selector = expression_type(block.condition).basetype == SPIRType::UInt;
+	const char *uint_suffix = backend.uint32_t_literal_suffix ? "u" : "";
+
+	const auto to_label = [&](uint32_t literal) -> string {
+		if (unsigned_selector)
+			return join(literal, uint_suffix);
+		else
+			return convert_to_string(int32_t(literal));
+	};
+
+	for (auto &output : constant_switch.outputs)
+	{
+		flush_variable_declaration(output.variable);
+		auto lhs = to_expression(output.variable);
+		const auto to_value = [&](uint32_t value) -> string { return value ? to_expression(value) : lhs; };
+
+		string rhs;
+		if (output.lookup_table)
+		{
+			// Labels outside the table select the default value.
+			auto &table_type = expression_type(output.lookup_table);
+			auto selector = to_expression(block.condition);
+			auto range_check = unsigned_selector ? to_enclosed_expression(block.condition) : join("uint(", selector, ")");
+			rhs = join(range_check, " < ", to_array_size_literal(table_type), uint_suffix, " ? ",
+			           to_expression(output.lookup_table), "[", selector, "] : ", to_value(output.default_value));
+		}
+		else
+		{
+			// Merge labels which select the same value. Labels which select the default value are redundant.
+			SmallVector<uint32_t> values;
+			SmallVector<string> conditions;
+			for (size_t i = 0; i < constant_switch.case_literals.size(); i++)
+			{
+				uint32_t value = output.case_values[i];
+				if (value == output.default_value)
+					continue;
+
+				auto condition = join(to_enclosed_expression(block.condition), " == ",
+				                      to_label(constant_switch.case_literals[i]));
+				auto value_itr = find(begin(values), end(values), value);
+				if (value_itr == end(values))
+				{
+					values.push_back(value);
+					conditions.push_back(std::move(condition));
+				}
+				else
+					conditions[value_itr - begin(values)] += join(" || ", condition);
+			}
+
+			rhs = to_value(output.default_value);
+			for (size_t i = values.size(); i; i--)
+				rhs = join(enclose_expression(conditions[i - 1]), " ? ", to_value(values[i - 1]), " : ", rhs);
+		}
+
+		statement(lhs, " = ", rhs, ";");
+		register_write(output.variable);
+	}
+
+	return true;
+}
+
 void CompilerGLSL::emit_block_chain(SPIRBlock &block)
 {
 	bool select_branch_to_true_block = false;
@@ -16944,6 +17383,9 @@ void CompilerGLSL::emit_block_chain(SPIRBlock &block)
 
 	case SPIRBlock::MultiSelect:
 	{
+		if (emit_constant_switch(block))
+			break;
+
 		auto &type = expression_type(block.condition);
 		bool unsigned_case = type.basetype == SPIRType::UInt || type.basetype == SPIRType::UShort ||
 		                     type.basetype == SPIRType::UByte || type.basetype == SPIRType::UInt64;
@@ -17609,7 +18051,11 @@ void CompilerGLSL::unroll_array_from_complex_load(uint32_t target_id, uint32_t s
 	                  (builtin == BuiltInPointSize ||
 	                   builtin == BuiltInPosition ||
 	                   builtin == BuiltInSampleMask);
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	bool is_tess = is_tessellation_shader();
+#else
+	bool is_tess = false;
+#endif
 	bool is_patch = has_decoration(var->self, DecorationPatch);
 	bool is_sample_mask = is_builtin && builtin == BuiltInSampleMask;
 
@@ -145,6 +145,30 @@ public:
 		// compares.
 		bool relax_nan_checks = false;
 
+		// Decide up front which expressions to bind to temporaries based on how often they are read
+		// and how expensive they are to recompute, rather than discovering multiple reads during compilation.
+		// Expensive expressions which are read more than once are always bound to a temporary in the first pass,
+		// saving recompilation passes, while single trivial operations may be duplicated instead.
+		bool materialize_reused_expressions = false;
+
+		// For ES and Vulkan GLSL, infer relaxed precision for the whole module before emitting code.
+		// Values which are only moved around (loads, extracts, constructs and PHIs) become mediump when all their
+		// inputs are mediump, or when every consumer is a RelaxedPrecision operation which would truncate them anyway.
+		// This avoids most of the highp/mediump mirror copies the per-instruction analysis has to introduce.
+		// Arithmetic always keeps the precision declared in SPIR-V.
+		bool infer_relaxed_precision = false;
+
+		// Move loads from UBOs, push constants and non-writable SSBOs out of loops when they provably read
+		// the same value on every iteration, and bind them to a temporary before the loop.
+		// Unoptimized SPIR-V tends to reload such values in every iteration.
+		// Loads with non-constant indices are only hoisted if they execute whenever the loop is entered.
+		bool hoist_loop_invariant_loads = false;
+
+		// Emit switches where every case label only selects constants for variables used after the switch
+		// as a constant lookup table or a chain of ternary selects rather than a switch statement.
+		// Lookup tables are used when there are at least 3 non-negative case labels covering at least half the table.
+		bool lower_constant_switches = false;
+
 		// Loading row-major matrices from UBOs on older AMD Windows OpenGL drivers is problematic.
 		// To load these types correctly, we must generate a wrapper. them in a dummy function which only purpose is to
 		// ensure row_major decoration is actually respected.
@@ -264,8 +288,11 @@ public:
 
 	// Legacy GLSL compatibility method.
 	// Takes a uniform or push constant variable and flattens it into a (i|u)vec4 array[N]; array instead.
-	// For this to work, all types in the block must be the same basic type, e.g. mixing vec2 and vec4 is fine, but
-	// mixing int and float is not.
+	// If all types in the block share the same basic type, e.g. vec2 and vec4, the array uses that basic type.
+	// Blocks which mix float, int and uint are flattened into a highp vec4 array, and the bits of integer members
+	// are reinterpreted with floatBitsToInt() and floatBitsToUint() on access.
+	// Legacy ESSL has no such bitcasts, so integer members are converted by value there,
+	// and must be uploaded as float values, e.g. 3 as 3.0f.
 	// The name of the uniform array will be the same as the interface block name.
 	void flatten_buffer_block(VariableID id);
 
@@ -287,6 +314,20 @@ public:
 	void mask_stage_output_by_location(uint32_t location, uint32_t component);
 	void mask_stage_output_by_builtin(spv::BuiltIn builtin);
 
+	// After compilation, query how many arithmetic operations run in mediump and highp,
+	// and how many copies were needed to move values between precisions.
+	// Operation precision is what the SPIR-V declares, values which were only made mediump
+	// by infer_relaxed_precision are counted separately.
+	// Only meaningful for ES and Vulkan GLSL, where precision qualifiers are emitted.
+	struct PrecisionReport
+	{
+		uint32_t mediump_operations = 0;
+		uint32_t highp_operations = 0;
+		uint32_t precision_copies = 0;
+		uint32_t inferred_mediump_values = 0;
+	};
+	PrecisionReport get_precision_report() const;
+
 protected:
 	struct ShaderSubgroupSupportHelper
 	{
@@ -656,6 +697,7 @@ protected:
 	void emit_buffer_reference_block(uint32_t type_id, bool forward_declaration);
 	void emit_buffer_block_legacy(const SPIRVariable &var);
 	void emit_buffer_block_flattened(const SPIRVariable &type);
+	SPIRType::BaseType flattened_buffer_block_basic_type(const SPIRType &type);
 	void fixup_implicit_builtin_block_names(spv::ExecutionModel model);
 	void emit_declared_builtin_block(spv::StorageClass storage, spv::ExecutionModel model);
 	bool should_force_emit_builtin_block(spv::StorageClass storage);
@@ -668,6 +710,7 @@ protected:
 	void emit_flattened_io_block_member(const std::string &basename, const SPIRType &type, const char *qual,
 	                                    const SmallVector<uint32_t> &indices);
 	void emit_block_chain(SPIRBlock &block);
+	bool emit_constant_switch(const SPIRBlock &block);
 	void emit_hoisted_temporaries(SmallVector<std::pair<TypeID, ID>> &temporaries);
 	std::string constant_value_macro_name(uint32_t id);
 	int get_constant_mapping_to_workgroup_component(const SPIRConstant &constant) const;
@@ -858,6 +901,8 @@ protected:
 	void forward_relaxed_precision(uint32_t dst_id, const uint32_t *args, uint32_t length);
 	void analyze_precision_requirements(uint32_t type_id, uint32_t dst_id, uint32_t *args, uint32_t length);
 	Options::Precision analyze_expression_precision(const uint32_t *args, uint32_t length) const;
+	void analyze_relaxed_precision_dataflow();
+	void reset_relaxed_precision_dataflow();
 
 	uint32_t indent = 0;
 
@@ -969,6 +1014,11 @@ protected:
 
 	uint32_t consume_temporary_in_precision_context(uint32_t type_id, uint32_t id, Options::Precision precision);
 	std::unordered_map<uint32_t, uint32_t> temporary_to_mirror_precision_alias;
+	// RelaxedPrecision decorations and temporaries added by precision inference, undone before the next compile().
+	// Forwarded decorations are the ones forward_relaxed_precision() added while inference was enabled.
+	SmallVector<uint32_t> inferred_relaxed_precision;
+	SmallVector<uint32_t> forwarded_relaxed_precision;
+	SmallVector<uint32_t> inferred_precision_temporaries;
 	std::unordered_set<uint32_t> composite_insert_overwritten;
 	std::unordered_set<uint32_t> block_composite_insert_overwrite;
 
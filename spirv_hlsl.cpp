@@ -26,6 +26,7 @@
 #include "GLSL.std.450.h"
 #include <algorithm>
 #include <assert.h>
+#include <cmath>
 
 using namespace spv;
 using namespace SPIRV_CROSS_NAMESPACE;
@@ -1871,8 +1872,10 @@ void CompilerHLSL::emit_resources()
 	switch (execution.model)
 	{
 	case ExecutionModelGeometry:
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	case ExecutionModelTessellationControl:
 	case ExecutionModelTessellationEvaluation:
+#endif
 	case ExecutionModelMeshEXT:
 		fixup_implicit_builtin_block_names(execution.model);
 		break;
@@ -1960,7 +1963,7 @@ void CompilerHLSL::emit_resources()
 
 			if (var.storage != StorageClassFunction && !var.remapped_variable && type.pointer &&
 			   (var.storage == StorageClassInput || var.storage == StorageClassOutput) && !is_builtin_variable(var) &&
-			   interface_variable_exists_in_entry_point(var.self))
+			   interface_variable_exists_in_entry_point(var.self) && !direct_stage_io_variables.count(var.self))
 			{
 				// Builtin variables are handled separately.
 				emit_interface_block_globally(var);
@@ -2756,7 +2759,9 @@ void CompilerHLSL::emit_buffer_block(const SPIRVariable &var)
 		};
 
 		std::string type_name;
-		if (is_user_type_structured(var.self))
+		if (is_ssbo_typed_buffer(var))
+			type_name = join("Buffer<", to_structuredbuffer_subtype_name(type), ">");
+		else if (is_user_type_structured(var.self))
 			type_name = join(is_readonly ? "" : is_interlocked ? "RasterizerOrdered" : "RW", "StructuredBuffer<", to_structuredbuffer_subtype_name(type), ">");
 		else
 			type_name = is_readonly ? "ByteAddressBuffer" : is_interlocked ? "RasterizerOrderedByteAddressBuffer" : "RWByteAddressBuffer";
@@ -3020,6 +3025,15 @@ void CompilerHLSL::emit_function_prototype(SPIRFunction &func, const Bitset &ret
 			var->parameter = &arg;
 	}
 
+	// Stage IO which is not copied through globals is accessed through the IO structs directly.
+	if (func.self == ir.default_entry_point)
+	{
+		if (direct_stage_input)
+			arglist.push_back("SPIRV_Cross_Input stage_input");
+		if (direct_stage_output)
+			arglist.push_back("inout SPIRV_Cross_Output stage_output");
+	}
+
 	decl += merge(arglist);
 	decl += ")";
 	statement(decl);
@@ -3184,6 +3198,7 @@ void CompilerHLSL::emit_hlsl_entry_point()
 		case BuiltInHelperInvocation:
 			break;
 
+#ifndef SPIRV_CROSS_NO_SUBGROUP_EMULATION
 		case BuiltInSubgroupEqMask:
 #ifndef SPIRV_CROSS_WEBMIN
 			// Emulate these ...
@@ -3255,6 +3270,14 @@ void CompilerHLSL::emit_hlsl_entry_point()
 			statement("if (WaveGetLaneIndex() < 96) gl_SubgroupLtMask.w = 0u;");
 #endif
 			break;
+#else
+		case BuiltInSubgroupEqMask:
+		case BuiltInSubgroupGeMask:
+		case BuiltInSubgroupGtMask:
+		case BuiltInSubgroupLeMask:
+		case BuiltInSubgroupLtMask:
+			SPIRV_CROSS_THROW("Subgroup mask emulation was compiled out (SPIRV_CROSS_NO_SUBGROUP_EMULATION).");
+#endif // SPIRV_CROSS_NO_SUBGROUP_EMULATION
 
 		case BuiltInClipDistance:
 #ifndef SPIRV_CROSS_WEBMIN
@@ -3289,7 +3312,7 @@ void CompilerHLSL::emit_hlsl_entry_point()
 		bool need_matrix_unroll = var.storage == StorageClassInput && execution.model == ExecutionModelVertex;
 
 		if (!var.remapped_variable && type.pointer && !is_builtin_variable(var) &&
-		    interface_variable_exists_in_entry_point(var.self))
+		    interface_variable_exists_in_entry_point(var.self) && !direct_stage_io_variables.count(var.self))
 		{
 			if (block)
 			{
@@ -3335,6 +3358,14 @@ void CompilerHLSL::emit_hlsl_entry_point()
 		// The arguments are marked out, avoid detecting reads and emitting inout.
 		for (auto &arg : func.arguments)
 			arglist.push_back(to_expression(arg.id, false));
+		if (direct_stage_input)
+			arglist.push_back("stage_input");
+		if (direct_stage_output)
+		{
+			// Like the static globals it replaces, outputs which are never written must read as zero.
+			statement("SPIRV_Cross_Output stage_output = (SPIRV_Cross_Output)0;");
+			arglist.push_back("stage_output");
+		}
 		statement(get_inner_entry_point_name(), "(", merge(arglist), ");");
 	}
 	else
@@ -3343,7 +3374,8 @@ void CompilerHLSL::emit_hlsl_entry_point()
 	// Copy stage outputs.
 	if (require_output)
 	{
-		statement("SPIRV_Cross_Output stage_output;");
+		if (!direct_stage_output)
+			statement("SPIRV_Cross_Output stage_output;");
 
 		// Copy builtins from globals to return struct.
 		active_output_builtins.for_each_bit([&](uint32_t i) {
@@ -3383,7 +3415,8 @@ void CompilerHLSL::emit_hlsl_entry_point()
 
 			if (!var.remapped_variable && type.pointer &&
 			    !is_builtin_variable(var) &&
-			    interface_variable_exists_in_entry_point(var.self))
+			    interface_variable_exists_in_entry_point(var.self) &&
+			    !direct_stage_io_variables.count(var.self))
 			{
 				if (block)
 				{
@@ -4133,8 +4166,10 @@ void CompilerHLSL::emit_uniform(const SPIRVariable &var)
 	add_resource_name(var.self);
 	if (hlsl_options.shader_model >= 40)
 		emit_modern_uniform(var);
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 	else
 		emit_legacy_uniform(var);
+#endif
 }
 
 bool CompilerHLSL::emit_complex_bitcast(uint32_t, uint32_t, uint32_t)
@@ -5083,6 +5118,9 @@ void CompilerHLSL::emit_instruction(const Instruction &instruction)
 
 	case OpImageQuerySizeLod:
 	{
+		if (emit_cached_texture_query(ops))
+			break;
+
 #ifndef SPIRV_CROSS_WEBMIN
 		auto result_type = ops[0];
 		auto id = ops[1];
@@ -5105,6 +5143,9 @@ void CompilerHLSL::emit_instruction(const Instruction &instruction)
 
 	case OpImageQuerySize:
 	{
+		if (emit_cached_texture_query(ops))
+			break;
+
 #ifndef SPIRV_CROSS_WEBMIN
 		auto result_type = ops[0];
 		auto id = ops[1];
@@ -5137,6 +5178,9 @@ void CompilerHLSL::emit_instruction(const Instruction &instruction)
 	case OpImageQuerySamples:
 	case OpImageQueryLevels:
 	{
+		if (emit_cached_texture_query(ops))
+			break;
+
 #ifndef SPIRV_CROSS_WEBMIN
 		auto result_type = ops[0];
 		auto id = ops[1];
@@ -5493,6 +5537,23 @@ void CompilerHLSL::emit_instruction(const Instruction &instruction)
 
 		// This must be 32-bit uint, so we're good to go.
 		emit_uninitialized_temporary_expression(ops[0], ops[1]);
+
+		if (is_ssbo_typed_buffer(*var))
+		{
+			// Typed buffers report the element count directly.
+			statement(to_non_uniform_aware_expression(ops[2]), ".GetDimensions(", to_expression(ops[1]), ");");
+			break;
+		}
+		else if (is_user_type_structured(var->self))
+		{
+			// Structured buffers report the element count, but the stride must be queried along with it.
+			auto stride_name = join(to_name(ops[1]), "_stride");
+			statement("uint ", stride_name, ";");
+			statement(to_non_uniform_aware_expression(ops[2]), ".GetDimensions(", to_expression(ops[1]), ", ",
+			          stride_name, ");");
+			break;
+		}
+
 		statement(to_non_uniform_aware_expression(ops[2]), ".GetDimensions(", to_expression(ops[1]), ");");
 		uint32_t offset = type_struct_member_offset(type, ops[3]);
 		uint32_t stride = type_struct_member_array_stride(type, ops[3]);
@@ -5525,6 +5586,7 @@ void CompilerHLSL::emit_instruction(const Instruction &instruction)
 #endif
 		break; // Nothing to do in the body
 
+#ifndef SPIRV_CROSS_NO_RAY_TRACING
 	case OpRayQueryInitializeKHR:
 	{
 #ifndef SPIRV_CROSS_WEBMIN
@@ -5754,6 +5816,8 @@ void CompilerHLSL::emit_instruction(const Instruction &instruction)
 #endif
 		break;
 	}
+#endif // SPIRV_CROSS_NO_RAY_TRACING
+#ifndef SPIRV_CROSS_NO_MESH_SHADING
 	case OpSetMeshOutputsEXT:
 	{
 #ifndef SPIRV_CROSS_WEBMIN
@@ -5763,6 +5827,7 @@ void CompilerHLSL::emit_instruction(const Instruction &instruction)
 #endif
 		break;
 	}
+#endif // SPIRV_CROSS_NO_MESH_SHADING
 	default:
 		CompilerGLSL_emit_instruction(instruction);
 		break;
@@ -5813,6 +5878,11 @@ void CompilerHLSL::validate_shader_model()
 string CompilerHLSL::compile()
 {
 	ir.fixup_reserved_names();
+	validate_compiled_features();
+#ifdef SPIRV_CROSS_NO_LEGACY_TARGETS
+	if (hlsl_options.shader_model <= 30)
+		SPIRV_CROSS_THROW("Shader Model 3.0 support was compiled out (SPIRV_CROSS_NO_LEGACY_TARGETS).");
+#endif
 
 	// Do not deal with ES-isms like precision, older extensions and such.
 	options.es = false;
@@ -5849,13 +5919,28 @@ string CompilerHLSL::compile()
 	fixup_anonymous_struct_names();
 	fixup_type_alias();
 	reorder_type_alias();
+	restore_loop_invariant_loads();
+	if (options.hoist_loop_invariant_loads)
+		hoist_loop_invariant_loads();
 	build_function_control_flow_graphs_and_analyze();
+	if (options.materialize_reused_expressions)
+		analyze_expression_reuse(temporary_to_mirror_precision_alias);
+	else
+		reset_expression_reuse();
+	if (options.lower_constant_switches)
+		analyze_constant_switches(true);
+	else
+		reset_constant_switches();
 	validate_shader_model();
 	update_active_builtins();
 	analyze_image_and_sampler_usage();
 	analyze_interlocked_resource_usage();
+#ifndef SPIRV_CROSS_NO_MESH_SHADING
 	if (get_execution_model() == ExecutionModelMeshEXT)
 		analyze_meshlet_writes();
+#endif
+	analyze_direct_stage_io();
+	analyze_texture_queries();
 
 	// Subpass input needs SV_Position.
 	if (need_subpass_input)
@@ -5917,13 +6002,385 @@ bool CompilerHLSL::is_user_type_structured(uint32_t id) const
 		// Compare left hand side of string only as these user types can contain more meta data such as their subtypes,
 		// e.g. "structuredbuffer:int"
 		const std::string &user_type = get_decoration_string(id, DecorationUserTypeGOOGLE);
-		return user_type.compare(0, 16, "structuredbuffer") == 0 ||
-		       user_type.compare(0, 18, "rwstructuredbuffer") == 0 ||
-		       user_type.compare(0, 33, "rasterizerorderedstructuredbuffer") == 0;
+		bool is_structured = user_type.compare(0, 16, "structuredbuffer") == 0 ||
+		                     user_type.compare(0, 18, "rwstructuredbuffer") == 0 ||
+		                     user_type.compare(0, 33, "rasterizerorderedstructuredbuffer") == 0;
+		if (is_structured)
+			return true;
 	}
+
+	if (hlsl_options.infer_structured_buffers || hlsl_options.infer_typed_buffers)
+	{
+		auto *var = maybe_get<SPIRVariable>(id);
+		if (var && (is_ssbo_structured_buffer(*var) || is_ssbo_typed_buffer(*var)))
+			return true;
+	}
+
 	return false;
 }
 
+const SPIRType *CompilerHLSL::get_ssbo_runtime_array_type(const SPIRVariable &var) const
+{
+	auto &type = get<SPIRType>(var.basetype);
+	if (type.basetype != SPIRType::Struct || type.member_types.size() != 1)
+		return nullptr;
+	if (var.storage != StorageClassStorageBuffer &&
+	    !(var.storage == StorageClassUniform && has_decoration(type.self, DecorationBufferBlock)))
+		return nullptr;
+	if (flattened_buffer_blocks.count(var.self))
+		return nullptr;
+	if (type_struct_member_offset(type, 0) != 0)
+		return nullptr;
+
+	auto &member_type = get<SPIRType>(type.member_types[0]);
+	if (member_type.array.size() != 1 || !member_type.array_size_literal.back() || member_type.array.back() != 0)
+		return nullptr;
+	if (has_member_decoration(type.self, 0, DecorationRowMajor) || has_member_decoration(type.self, 0, DecorationColMajor))
+		return nullptr;
+
+	return &member_type;
+}
+
+// Computes the size of a type as laid out in a HLSL structured buffer, where everything is tightly packed
+// on 4 byte boundaries. Fails if the SPIR-V layout of the type differs from that.
+bool CompilerHLSL::get_structured_buffer_element_size(const SPIRType &type, uint32_t &size) const
+{
+	if (type.pointer || type.columns != 1)
+		return false;
+
+	if (!type.array.empty())
+		return false;
+
+	switch (type.basetype)
+	{
+	case SPIRType::Float:
+	case SPIRType::Int:
+	case SPIRType::UInt:
+		if (type.width != 32)
+			return false;
+		size = 4 * type.vecsize;
+		return true;
+
+	case SPIRType::Struct:
+	{
+		uint32_t offset = 0;
+		for (uint32_t i = 0; i < uint32_t(type.member_types.size()); i++)
+		{
+			if (!has_member_decoration(type.self, i, DecorationOffset) || type_struct_member_offset(type, i) != offset)
+				return false;
+
+			auto &member_type = get<SPIRType>(type.member_types[i]);
+			uint32_t member_size = 0;
+			if (member_type.array.size() == 1 && member_type.array_size_literal.back() && member_type.array.back() != 0)
+			{
+				// Arrays are tightly packed as well, so the stride must match the element size.
+				auto &element_type = get<SPIRType>(member_type.parent_type);
+				if (!get_structured_buffer_element_size(element_type, member_size) ||
+				    type_struct_member_array_stride(type, i) != member_size)
+					return false;
+				member_size *= member_type.array.back();
+			}
+			else if (!get_structured_buffer_element_size(member_type, member_size))
+				return false;
+
+			offset += member_size;
+		}
+		size = offset;
+		return offset != 0;
+	}
+
+	default:
+		return false;
+	}
+}
+
+bool CompilerHLSL::is_ssbo_structured_buffer(const SPIRVariable &var) const
+{
+	if (!hlsl_options.infer_structured_buffers)
+		return false;
+
+	auto *array_type = get_ssbo_runtime_array_type(var);
+	if (!array_type)
+		return false;
+
+	uint32_t element_size = 0;
+	auto &element_type = get<SPIRType>(array_type->parent_type);
+	return get_structured_buffer_element_size(element_type, element_size) &&
+	       type_struct_member_array_stride(get<SPIRType>(var.basetype), 0) == element_size;
+}
+
+bool CompilerHLSL::is_ssbo_typed_buffer(const SPIRVariable &var) const
+{
+	if (!hlsl_options.infer_typed_buffers)
+		return false;
+
+	Bitset flags = ir.get_buffer_block_flags(var);
+	if (!flags.get(DecorationNonWritable) || is_hlsl_force_storage_buffer_as_uav(var.self))
+		return false;
+
+	auto *array_type = get_ssbo_runtime_array_type(var);
+	if (!array_type)
+		return false;
+
+	auto &element_type = get<SPIRType>(array_type->parent_type);
+	if (!element_type.array.empty() || element_type.columns != 1 || element_type.vecsize != 4 ||
+	    element_type.width != 32)
+		return false;
+	if (element_type.basetype != SPIRType::Float && element_type.basetype != SPIRType::Int &&
+	    element_type.basetype != SPIRType::UInt)
+		return false;
+
+	return type_struct_member_array_stride(get<SPIRType>(var.basetype), 0) == 16;
+}
+
+// Returns the number of size components and whether GetDimensions() takes a LOD and returns a levels or sample count.
+static bool get_texture_query_layout(const SPIRType &type, bool uav, uint32_t &components, bool &has_lod, bool &has_param)
+{
+	switch (type.image.dim)
+	{
+	case Dim1D:
+		components = type.image.arrayed ? 2 : 1;
+		break;
+	case Dim2D:
+	case DimCube:
+		components = type.image.arrayed ? 3 : 2;
+		break;
+	case Dim3D:
+		components = 3;
+		break;
+	case DimBuffer:
+		components = 1;
+		break;
+	default:
+		return false;
+	}
+
+	has_lod = !uav && !type.image.ms && type.image.dim != DimBuffer;
+	has_param = !uav && (has_lod || type.image.ms);
+	return true;
+}
+
+void CompilerHLSL::analyze_texture_queries()
+{
+	cached_texture_queries.clear();
+	cached_texture_query_results.clear();
+
+	if (!hlsl_options.cache_texture_queries || hlsl_options.shader_model < 40)
+		return;
+
+	ir.for_each_typed_id<SPIRFunction>([&](uint32_t func_id, SPIRFunction &func) {
+		// Trace image operands back to the resource variable through OpLoad, OpSampledImage and OpImage.
+		unordered_map<uint32_t, uint32_t> image_sources;
+		for (auto block : func.blocks)
+		{
+			for (auto &i : get<SPIRBlock>(block).ops)
+			{
+				auto *ops = stream(i);
+				auto op = static_cast<Op>(i.op);
+				if (op == OpLoad || op == OpSampledImage || op == OpImage)
+					image_sources[ops[1]] = ops[2];
+			}
+		}
+
+		const auto resolve_image = [&](uint32_t id) -> const SPIRVariable * {
+			for (;;)
+			{
+				auto *var = maybe_get<SPIRVariable>(id);
+				if (var)
+					return var->storage == StorageClassUniformConstant ? var : nullptr;
+				auto itr = image_sources.find(id);
+				if (itr == image_sources.end())
+					return nullptr;
+				id = itr->second;
+			}
+		};
+
+		auto &queries = cached_texture_queries[func_id];
+
+		for (auto block : func.blocks)
+		{
+			for (auto &i : get<SPIRBlock>(block).ops)
+			{
+				auto *ops = stream(i);
+				auto op = static_cast<Op>(i.op);
+				if (op != OpImageQuerySize && op != OpImageQuerySizeLod && op != OpImageQueryLevels &&
+				    op != OpImageQuerySamples)
+					continue;
+
+				auto *var = resolve_image(ops[2]);
+				if (!var || has_decoration(var->self, DecorationNonUniform))
+					continue;
+
+				auto &type = get_variable_data_type(*var);
+				if (!type.array.empty() || (type.basetype != SPIRType::Image && type.basetype != SPIRType::SampledImage))
+					continue;
+
+				bool uav = type.image.sampled == 2;
+				if (hlsl_options.nonwritable_uav_texture_as_srv && has_decoration(var->self, DecorationNonWritable))
+					uav = false;
+
+				uint32_t components;
+				bool has_lod, has_param;
+				if (!get_texture_query_layout(type, uav, components, has_lod, has_param))
+					continue;
+
+				// Only constant LODs can be queried at function entry.
+				uint32_t lod = 0;
+				if (op == OpImageQuerySizeLod)
+				{
+					auto *c = maybe_get<SPIRConstant>(ops[3]);
+					if (!c || !has_lod)
+						continue;
+					if (c->specialization || c->scalar() != 0)
+						lod = ops[3];
+				}
+
+				bool wants_param = op == OpImageQueryLevels || op == OpImageQuerySamples;
+				if (wants_param && !has_param)
+					continue;
+
+				auto itr = find_if(queries.begin(), queries.end(), [&](const CachedTextureQuery &q) {
+					return q.image == var->self && q.lod == lod;
+				});
+
+				if (itr == queries.end())
+				{
+					auto &allocated = allocated_texture_queries[func_id];
+					auto allocated_itr = find_if(allocated.begin(), allocated.end(), [&](const CachedTextureQuery &q) {
+						return q.image == var->self && q.lod == lod;
+					});
+					if (allocated_itr == allocated.end())
+					{
+						uint32_t ids = ir.increase_bound_by(2);
+						allocated.push_back({ var->self, lod, ids, ids + 1 });
+						allocated_itr = allocated.end() - 1;
+					}
+
+					queries.push_back(*allocated_itr);
+					itr = queries.end() - 1;
+				}
+
+				cached_texture_query_results[ops[1]] = wants_param ? itr->param_id : itr->size_id;
+			}
+		}
+
+		if (queries.empty())
+			cached_texture_queries.erase(func_id);
+	});
+}
+
+bool CompilerHLSL::emit_cached_texture_query(const uint32_t *ops)
+{
+	auto itr = cached_texture_query_results.find(ops[1]);
+	if (itr == cached_texture_query_results.end())
+		return false;
+
+	auto &restype = get<SPIRType>(ops[0]);
+	emit_op(ops[0], ops[1], bitcast_expression(restype, SPIRType::UInt, to_name(itr->second)), true);
+	return true;
+}
+
+void CompilerHLSL::emit_cached_texture_queries(const SPIRFunction &func)
+{
+	auto func_itr = cached_texture_queries.find(func.self);
+	if (func_itr == cached_texture_queries.end())
+		return;
+
+	for (auto &q : func_itr->second)
+	{
+		auto &type = get_variable_data_type(get<SPIRVariable>(q.image));
+		bool uav = type.image.sampled == 2;
+		if (hlsl_options.nonwritable_uav_texture_as_srv && has_decoration(q.image, DecorationNonWritable))
+			uav = false;
+
+		uint32_t components = 0;
+		bool has_lod = false, has_param = false;
+		get_texture_query_layout(type, uav, components, has_lod, has_param);
+
+		auto image_name = to_name(q.image);
+		if (q.lod)
+		{
+			auto &c = get<SPIRConstant>(q.lod);
+			image_name += join("_lod", c.specialization ? to_name(q.lod) : to_string(c.scalar()));
+		}
+
+		set_name(q.size_id, join(image_name, "_size"));
+		add_local_variable_name(q.size_id);
+		statement(components == 1 ? "uint " : join("uint", components, " "), to_name(q.size_id), ";");
+
+		SmallVector<string> args;
+		if (has_lod)
+			args.push_back(q.lod ? bitcast_expression(SPIRType::UInt, q.lod) : "0u");
+		for (uint32_t c = 0; c < components; c++)
+			args.push_back(components == 1 ? to_name(q.size_id) : join(to_name(q.size_id), ".", "xyz"[c]));
+
+		if (has_param)
+		{
+			set_name(q.param_id, join(image_name, type.image.ms ? "_samples" : "_levels"));
+			add_local_variable_name(q.param_id);
+			statement("uint ", to_name(q.param_id), ";");
+			args.push_back(to_name(q.param_id));
+		}
+
+		statement(to_expression(q.image), ".GetDimensions(", merge(args), ");");
+	}
+}
+
+void CompilerHLSL::analyze_direct_stage_io()
+{
+	direct_stage_io_variables.clear();
+	direct_stage_input = false;
+	direct_stage_output = false;
+
+	auto model = get_execution_model();
+	if (!hlsl_options.elide_stage_io_copies || hlsl_options.shader_model <= 30 ||
+	    (model != ExecutionModelVertex && model != ExecutionModelFragment))
+		return;
+
+	ir.for_each_typed_id<SPIRVariable>([&](uint32_t, SPIRVariable &var) {
+		if (var.storage != StorageClassInput && var.storage != StorageClassOutput)
+			return;
+
+		auto &type = get<SPIRType>(var.basetype);
+		if (var.remapped_variable || !type.pointer || is_builtin_variable(var) || var.initializer ||
+		    has_decoration(type.self, DecorationBlock) || !interface_variable_exists_in_entry_point(var.self))
+			return;
+
+		// Vertex input matrices are unrolled into one member per column.
+		if (model == ExecutionModelVertex && var.storage == StorageClassInput && type.columns > 1)
+			return;
+
+		direct_stage_io_variables.insert(var.self);
+	});
+
+	if (direct_stage_io_variables.empty())
+		return;
+
+	// Any other function would need access to the IO structs, so keep the globals for those variables.
+	ir.for_each_typed_id<SPIRFunction>([&](uint32_t func_id, SPIRFunction &func) {
+		if (func_id == ir.default_entry_point)
+			return;
+
+		for (auto block : func.blocks)
+		{
+			for (auto &i : get<SPIRBlock>(block).ops)
+			{
+				auto *ops = stream(i);
+				for (uint32_t j = 0; j < i.length; j++)
+					direct_stage_io_variables.erase(ops[j]);
+			}
+		}
+	});
+
+	for (auto &id : direct_stage_io_variables)
+	{
+		if (get<SPIRVariable>(id).storage == StorageClassInput)
+			direct_stage_input = true;
+		else
+			direct_stage_output = true;
+	}
+}
+
 // GLSL Implementation
 
 void CompilerHLSL::add_resource_name(uint32_t id)
@@ -6326,6 +6783,8 @@ string CompilerHLSL::to_expression(uint32_t id, bool register_expression_read)
 			auto &dec = ir.meta[var.self].decoration;
 			if (dec.builtin)
 				return builtin_to_glsl(dec.builtin_type, var.storage);
+			else if (direct_stage_io_variables.count(id))
+				return join(var.storage == StorageClassInput ? "stage_input." : "stage_output.", to_name(id));
 			else
 				return to_name(id);
 		}
@@ -7105,7 +7564,9 @@ void CompilerHLSL::track_expression_read(uint32_t id)
 
 	// If we try to read a forwarded temporary more than once we will stamp out possibly complex code twice.
 	// In this case, it's better to just bind the complex expression to the temporary and read that temporary twice.
-	if (expression_is_forwarded(id) && !expression_suppresses_usage_tracking(id))
+	// Expressions which analyze_expression_reuse() deemed trivial are duplicated on purpose.
+	if (expression_is_forwarded(id) && !expression_suppresses_usage_tracking(id) &&
+	    duplicated_expressions.count(id) == 0)
 	{
 		auto &v = expression_usage_counts[id];
 		v++;
@@ -7502,6 +7963,7 @@ string CompilerHLSL::access_chain_internal(uint32_t base, const uint32_t *indice
 				// to consider scalar access chains here.
 				// Cleans up some cases where it's very painful to determine the accurate storage class
 				// since blocks can be partially masked ...
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 				auto *var = maybe_get_backing_variable(base);
 				if (var && var->storage == StorageClassOutput &&
 				    get_execution_model() == ExecutionModelTessellationControl &&
@@ -7509,6 +7971,7 @@ string CompilerHLSL::access_chain_internal(uint32_t base, const uint32_t *indice
 				{
 					ignore_potential_sliced_writes = true;
 				}
+#endif
 			}
 			else
 				ignore_potential_sliced_writes = true;
@@ -8236,6 +8699,8 @@ void CompilerHLSL::emit_function(SPIRFunction &func, const Bitset &return_flags)
 	for (auto &line : current_function->fixup_hooks_in)
 		line();
 
+	emit_cached_texture_queries(func);
+
 	emit_block_chain(entry_block);
 
 	end_scope();
@@ -8255,6 +8720,74 @@ void CompilerHLSL::emit_entry_point_declarations()
 {
 }
 
+bool CompilerHLSL::emit_constant_switch(const SPIRBlock &block)
+{
+	auto itr = constant_switches.find(block.self);
+	if (itr == end(constant_switches))
+		return false;
+
+	auto &constant_switch = itr->second;
+	bool unsigned_selector = expression_type(block.condition).basetype == SPIRType::UInt;
+	const char *uint_suffix = backend.uint32_t_literal_suffix ? "u" : "";
+
+	const auto to_label = [&](uint32_t literal) -> string {
+		if (unsigned_selector)
+			return join(literal, uint_suffix);
+		else
+			return convert_to_string(int32_t(literal));
+	};
+
+	for (auto &output : constant_switch.outputs)
+	{
+		flush_variable_declaration(output.variable);
+		auto lhs = to_expression(output.variable);
+		const auto to_value = [&](uint32_t value) -> string { return value ? to_expression(value) : lhs; };
+
+		string rhs;
+		if (output.lookup_table)
+		{
+			// Labels outside the table select the default value.
+			auto &table_type = expression_type(output.lookup_table);
+			auto selector = to_expression(block.condition);
+			auto range_check = unsigned_selector ? to_enclosed_expression(block.condition) : join("uint(", selector, ")");
+			rhs = join(range_check, " < ", to_array_size_literal(table_type), uint_suffix, " ? ",
+			           to_expression(output.lookup_table), "[", selector, "] : ", to_value(output.default_value));
+		}
+		else
+		{
+			// Merge labels which select the same value. Labels which select the default value are redundant.
+			SmallVector<uint32_t> values;
+			SmallVector<string> conditions;
+			for (size_t i = 0; i < constant_switch.case_literals.size(); i++)
+			{
+				uint32_t value = output.case_values[i];
+				if (value == output.default_value)
+					continue;
+
+				auto condition = join(to_enclosed_expression(block.condition), " == ",
+				                      to_label(constant_switch.case_literals[i]));
+				auto value_itr = find(begin(values), end(values), value);
+				if (value_itr == end(values))
+				{
+					values.push_back(value);
+					conditions.push_back(std::move(condition));
+				}
+				else
+					conditions[value_itr - begin(values)] += join(" || ", condition);
+			}
+
+			rhs = to_value(output.default_value);
+			for (size_t i = values.size(); i; i--)
+				rhs = join(enclose_expression(conditions[i - 1]), " ? ", to_value(values[i - 1]), " : ", rhs);
+		}
+
+		statement(lhs, " = ", rhs, ";");
+		register_write(output.variable);
+	}
+
+	return true;
+}
+
 void CompilerHLSL::emit_block_chain(SPIRBlock &block)
 {
 	bool select_branch_to_true_block = false;
@@ -8472,6 +9005,9 @@ void CompilerHLSL::emit_block_chain(SPIRBlock &block)
 
 	case SPIRBlock::MultiSelect:
 	{
+		if (emit_constant_switch(block))
+			break;
+
 		auto &type = expression_type(block.condition);
 		bool unsigned_case = type.basetype == SPIRType::UInt || type.basetype == SPIRType::UShort ||
 		                     type.basetype == SPIRType::UByte || type.basetype == SPIRType::UInt64;
@@ -8888,9 +9424,11 @@ void CompilerHLSL::emit_block_chain(SPIRBlock &block)
 		statement("terminateRayEXT;");
 		break;
 
+#ifndef SPIRV_CROSS_NO_MESH_SHADING
 	case SPIRBlock::EmitMeshTasks:
 		emit_mesh_tasks(block);
 		break;
+#endif // SPIRV_CROSS_NO_MESH_SHADING
 
 	default:
 		SPIRV_CROSS_THROW("Unimplemented block terminator.");
@@ -11161,12 +11699,14 @@ string CompilerHLSL::CompilerGLSL_builtin_to_glsl(BuiltIn builtin, StorageClass
 		return "gl_Layer";
 	case BuiltInViewportIndex:
 		return "gl_ViewportIndex";
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	case BuiltInTessLevelOuter:
 		return "gl_TessLevelOuter";
 	case BuiltInTessLevelInner:
 		return "gl_TessLevelInner";
 	case BuiltInTessCoord:
 		return "gl_TessCoord";
+#endif
 	case BuiltInFragCoord:
 		return "gl_FragCoord";
 	case BuiltInPointCoord:
@@ -14368,12 +14908,14 @@ void CompilerHLSL::CompilerGLSL_emit_instruction(const Instruction &instruction)
 		uint32_t id = ops[1];
 		uint32_t img = ops[2];
 		auto &type = expression_type(img);
-		auto &imgtype = get<SPIRType>(type.self);
 
 		std::string fname = "textureSize";
 		if (is_legacy_desktop())
 		{
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
+			auto &imgtype = get<SPIRType>(type.self);
 			fname = legacy_tex_op(fname, imgtype, img);
+#endif
 		}
 		else if (is_legacy_es())
 			SPIRV_CROSS_THROW("textureSize is not supported in ESSL 100.");
@@ -14676,11 +15218,13 @@ void CompilerHLSL::CompilerGLSL_emit_instruction(const Instruction &instruction)
 			{
 				// This path is hit for samplerBuffers and multisampled images which do not have LOD.
 				std::string fname = "textureSize";
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 				if (is_legacy())
 				{
 					auto &imgtype = get<SPIRType>(type.self);
 					fname = legacy_tex_op(fname, imgtype, ops[2]);
 				}
+#endif
 				expr = join(fname, "(", convert_separate_image_to_expression(ops[2]), ")");
 			}
 
@@ -14730,6 +15274,7 @@ void CompilerHLSL::CompilerGLSL_emit_instruction(const Instruction &instruction)
 			}
 		}
 
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 		if (execution_scope != ScopeSubgroup && get_entry_point().model == ExecutionModelTessellationControl)
 		{
 			// Control shaders only have barriers, and it implies memory barriers.
@@ -14737,6 +15282,7 @@ void CompilerHLSL::CompilerGLSL_emit_instruction(const Instruction &instruction)
 				statement("barrier();");
 			break;
 		}
+#endif
 
 		// We only care about these flags, acquire/release and friends are not relevant to GLSL.
 		semantics = mask_relevant_memory_semantics(semantics);
@@ -14876,6 +15422,7 @@ void CompilerHLSL::CompilerGLSL_emit_instruction(const Instruction &instruction)
 		{
 			emit_glsl_op(ops[0], ops[1], ops[3], &ops[4], length - 4);
 		}
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 		else if (ext == SPIRExtension::SPV_AMD_shader_ballot)
 		{
 			emit_spv_amd_shader_ballot_op(ops[0], ops[1], ops[3], &ops[4], length - 4);
@@ -14892,6 +15439,7 @@ void CompilerHLSL::CompilerGLSL_emit_instruction(const Instruction &instruction)
 		{
 			emit_spv_amd_gcn_shader_op(ops[0], ops[1], ops[3], &ops[4], length - 4);
 		}
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 		else if (ext == SPIRExtension::SPV_debug_info ||
 		         ext == SPIRExtension::NonSemanticShaderDebugInfo ||
 		         ext == SPIRExtension::NonSemanticGeneric)
@@ -15246,6 +15794,7 @@ void CompilerHLSL::CompilerGLSL_emit_instruction(const Instruction &instruction)
 		break;
 	}
 
+#ifndef SPIRV_CROSS_NO_RAY_TRACING
 	case OpReportIntersectionKHR:
 #ifndef SPIRV_CROSS_WEBMIN
 		// NV is same opcode.
@@ -15425,6 +15974,7 @@ void CompilerHLSL::CompilerGLSL_emit_instruction(const Instruction &instruction)
 #endif
 		break;
 	}
+#endif // SPIRV_CROSS_NO_RAY_TRACING
 
 	case OpConvertUToPtr:
 	{
@@ -15529,6 +16079,7 @@ void CompilerHLSL::CompilerGLSL_emit_instruction(const Instruction &instruction)
 #endif
 		break;
 
+#ifndef SPIRV_CROSS_NO_MESH_SHADING
 	case OpSetMeshOutputsEXT:
 #ifndef SPIRV_CROSS_WEBMIN
 		statement("SetMeshOutputsEXT(", to_unpacked_expression(ops[0]), ", ", to_unpacked_expression(ops[1]), ");");
@@ -15536,6 +16087,7 @@ void CompilerHLSL::CompilerGLSL_emit_instruction(const Instruction &instruction)
 		SPIRV_CROSS_INVALID_CALL();
 #endif
 		break;
+#endif // SPIRV_CROSS_NO_MESH_SHADING
 
 	case OpReadClockKHR:
 	{
@@ -15672,7 +16224,11 @@ void CompilerHLSL::unroll_array_from_complex_load(uint32_t target_id, uint32_t s
 	                  (builtin == BuiltInPointSize ||
 	                   builtin == BuiltInPosition ||
 	                   builtin == BuiltInSampleMask);
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	bool is_tess = is_tessellation_shader();
+#else
+	bool is_tess = false;
+#endif
 	bool is_patch = has_decoration(var->self, DecorationPatch);
 	bool is_sample_mask = is_builtin && builtin == BuiltInSampleMask;
 
@@ -16183,6 +16739,7 @@ CompilerHLSL::ShaderSubgroupSupportHelper::Result::Result()
 	weights[KHR_shader_subgroup_arithmetic] = big_num;
 }
 
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 string CompilerHLSL::image_type_hlsl_legacy(const SPIRType &type, uint32_t /*id*/)
 {
 	auto &imagetype = get<SPIRType>(type.image.type);
@@ -16249,13 +16806,15 @@ string CompilerHLSL::image_type_hlsl_legacy(const SPIRType &type, uint32_t /*id*
 
 	return res;
 }
+#endif // SPIRV_CROSS_NO_LEGACY_TARGETS
 
 string CompilerHLSL::image_type_hlsl(const SPIRType &type, uint32_t id)
 {
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 	if (hlsl_options.shader_model <= 30)
 		return image_type_hlsl_legacy(type, id);
-	else
-		return image_type_hlsl_modern(type, id);
+#endif
+	return image_type_hlsl_modern(type, id);
 }
 
 std::string CompilerHLSL::to_initializer_expression(const SPIRVariable &var)
@@ -16318,6 +16877,7 @@ bool CompilerHLSL::is_hlsl_aux_buffer_binding_used(HLSLAuxBinding binding) const
 		return false;
 }
 
+#ifndef SPIRV_CROSS_NO_MESH_SHADING
 void CompilerHLSL::analyze_meshlet_writes()
 {
 	uint32_t id_per_vertex = 0;
@@ -16400,7 +16960,9 @@ void CompilerHLSL::analyze_meshlet_writes()
 	unordered_set<uint32_t> processed_func_ids;
 	analyze_meshlet_writes(ir.default_entry_point, id_per_vertex, id_per_primitive, processed_func_ids);
 }
+#endif // SPIRV_CROSS_NO_MESH_SHADING
 
+#ifndef SPIRV_CROSS_NO_MESH_SHADING
 void CompilerHLSL::analyze_meshlet_writes(uint32_t func_id, uint32_t id_per_vertex, uint32_t id_per_primitive,
                                           std::unordered_set<uint32_t> &processed_func_ids)
 {
@@ -16505,14 +17067,18 @@ void CompilerHLSL::analyze_meshlet_writes(uint32_t func_id, uint32_t id_per_vert
 		}
 	}
 }
+#endif // SPIRV_CROSS_NO_MESH_SHADING
 
+#ifndef SPIRV_CROSS_NO_RAY_TRACING
 void CompilerHLSL::emit_rayquery_function(const char *commited, const char *candidate, const uint32_t *ops)
 {
 	flush_variable_declaration(ops[0]);
 	uint32_t is_commited = evaluate_constant_u32(ops[3]);
 	emit_op(ops[0], ops[1], join(to_expression(ops[2]), is_commited ? commited : candidate), false);
 }
+#endif // SPIRV_CROSS_NO_RAY_TRACING
 
+#ifndef SPIRV_CROSS_NO_MESH_SHADING
 void CompilerHLSL::emit_mesh_tasks(SPIRBlock &block)
 {
 	if (block.mesh.payload != 0)
@@ -16525,6 +17091,7 @@ void CompilerHLSL::emit_mesh_tasks(SPIRBlock &block)
 		SPIRV_CROSS_THROW("Amplification shader in HLSL must have payload");
 	}
 }
+#endif // SPIRV_CROSS_NO_MESH_SHADING
 
 void CompilerHLSL::emit_push_constant_block(const SPIRVariable &var)
 {
@@ -16592,6 +17159,7 @@ void CompilerHLSL::emit_push_constant_block(const SPIRVariable &var)
 	}
 }
 
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 void CompilerHLSL::emit_legacy_uniform(const SPIRVariable &var)
 {
 	auto &type = get<SPIRType>(var.basetype);
@@ -16606,6 +17174,7 @@ void CompilerHLSL::emit_legacy_uniform(const SPIRVariable &var)
 		break;
 	}
 }
+#endif // SPIRV_CROSS_NO_LEGACY_TARGETS
 
 string CompilerHLSL::bitcast_glsl_op(const SPIRType &out_type, const SPIRType &in_type)
 {
@@ -16671,6 +17240,23 @@ void CompilerHLSL::read_access_chain_array(const string &lhs, const SPIRAccessCh
 {
 	auto &type = get<SPIRType>(chain.basetype);
 
+	if (!coalesced_access_words.empty())
+	{
+		// All words have been loaded up front, so every element is addressed statically.
+		auto subchain = chain;
+		subchain.basetype = type.parent_type;
+		if (!get<SPIRType>(subchain.basetype).array.empty())
+			subchain.array_stride = get_decoration(subchain.basetype, DecorationArrayStride);
+
+		uint32_t array_size = to_array_size_literal(type);
+		for (uint32_t i = 0; i < array_size; i++)
+		{
+			subchain.static_index = chain.static_index + i * chain.array_stride;
+			read_access_chain(nullptr, join(lhs, "[", i, "]"), subchain);
+		}
+		return;
+	}
+
 	// Need to use a reserved identifier here since it might shadow an identifier in the access chain input or other loops.
 	auto ident = get_unique_identifier();
 
@@ -16728,18 +17314,27 @@ void CompilerHLSL::read_access_chain(string *expr, const string &lhs, const SPIR
 
 	if (!type.array.empty())
 	{
+		bool coalesced = begin_coalesced_access_chain_read(chain);
 		read_access_chain_array(lhs, chain);
+		if (coalesced)
+			coalesced_access_words.clear();
 		return;
 	}
 	else if (type.basetype == SPIRType::Struct)
 	{
+		bool coalesced = begin_coalesced_access_chain_read(chain);
 		read_access_chain_struct(lhs, chain);
+		if (coalesced)
+			coalesced_access_words.clear();
 		return;
 	}
 	else if (type.width != 32 && !hlsl_options.enable_16bit_types)
 		SPIRV_CROSS_THROW("Reading types other than 32-bit from ByteAddressBuffer not yet supported, unless SM 6.2 and "
 		                  "native 16-bit types are enabled.");
 
+	// Row-major matrices are otherwise loaded one scalar at a time.
+	bool coalesced = chain.row_major_matrix && begin_coalesced_access_chain_read(chain);
+
 	string base = chain.base;
 	if (has_decoration(chain.self, DecorationNonUniform))
 		convert_non_uniform_expression(base, chain.self);
@@ -16776,7 +17371,7 @@ void CompilerHLSL::read_access_chain(string *expr, const string &lhs, const SPIR
 		if (templated_load)
 			load_op = "Load";
 
-		load_expr = join(base, ".", load_op, template_expr, "(", chain.dynamic_index, chain.static_index, ")");
+		load_expr = read_access_chain_op(base, load_op, template_expr, chain, chain.static_index, type.vecsize);
 	}
 	else if (type.columns == 1)
 	{
@@ -16798,8 +17393,8 @@ void CompilerHLSL::read_access_chain(string *expr, const string &lhs, const SPIR
 
 		for (uint32_t r = 0; r < type.vecsize; r++)
 		{
-			load_expr += join(base, ".Load", template_expr, "(", chain.dynamic_index,
-			                  chain.static_index + r * chain.matrix_stride, ")");
+			load_expr += read_access_chain_op(base, "Load", template_expr, chain,
+			                                  chain.static_index + r * chain.matrix_stride, 1);
 			if (r + 1 < type.vecsize)
 				load_expr += ", ";
 		}
@@ -16847,8 +17442,9 @@ void CompilerHLSL::read_access_chain(string *expr, const string &lhs, const SPIR
 
 		for (uint32_t c = 0; c < type.columns; c++)
 		{
-			load_expr += join(base, ".", load_op, template_expr, "(", chain.dynamic_index,
-			                  chain.static_index + c * chain.matrix_stride, ")");
+			load_expr += read_access_chain_op(base, load_op, template_expr, chain,
+			                                  chain.static_index + c * chain.matrix_stride,
+			                                  templated_load ? 1 : type.vecsize);
 			if (c + 1 < type.columns)
 				load_expr += ", ";
 		}
@@ -16876,8 +17472,8 @@ void CompilerHLSL::read_access_chain(string *expr, const string &lhs, const SPIR
 		{
 			for (uint32_t r = 0; r < type.vecsize; r++)
 			{
-				load_expr += join(base, ".Load", template_expr, "(", chain.dynamic_index,
-				                  chain.static_index + c * (type.width / 8) + r * chain.matrix_stride, ")");
+				load_expr += read_access_chain_op(base, "Load", template_expr, chain,
+				                                  chain.static_index + c * (type.width / 8) + r * chain.matrix_stride, 1);
 
 				if ((r + 1 < type.vecsize) || (c + 1 < type.columns))
 					load_expr += ", ";
@@ -16893,6 +17489,9 @@ void CompilerHLSL::read_access_chain(string *expr, const string &lhs, const SPIR
 			load_expr = join(bitcast_op, "(", load_expr, ")");
 	}
 
+	if (coalesced)
+		coalesced_access_words.clear();
+
 	if (lhs.empty())
 	{
 		assert(expr);
@@ -16907,6 +17506,28 @@ void CompilerHLSL::write_access_chain_array(const SPIRAccessChain &chain, uint32
 {
 	auto &type = get<SPIRType>(chain.basetype);
 
+	if (coalescing_access_chain_write)
+	{
+		// Words are gathered and stored once the whole composite has been visited,
+		// so every element is addressed statically.
+		auto subchain = chain;
+		subchain.basetype = type.parent_type;
+		if (!get<SPIRType>(subchain.basetype).array.empty())
+			subchain.array_stride = get_decoration(subchain.basetype, DecorationArrayStride);
+
+		auto subcomposite_chain = composite_chain;
+		subcomposite_chain.push_back(0);
+
+		uint32_t array_size = to_array_size_literal(type);
+		for (uint32_t i = 0; i < array_size; i++)
+		{
+			subchain.static_index = chain.static_index + i * chain.array_stride;
+			subcomposite_chain.back() = i;
+			write_access_chain(subchain, value, subcomposite_chain);
+		}
+		return;
+	}
+
 	// Need to use a reserved identifier here since it might shadow an identifier in the access chain input or other loops.
 	auto ident = get_unique_identifier();
 
@@ -17007,13 +17628,23 @@ void CompilerHLSL::write_access_chain(const SPIRAccessChain &chain, uint32_t val
 
 	if (!type.array.empty())
 	{
+		bool coalesced = access_chain_is_coalescable(chain);
+		if (coalesced)
+			coalescing_access_chain_write = true;
 		write_access_chain_array(chain, value, composite_chain);
+		if (coalesced)
+			end_coalesced_access_chain_write(chain);
 		register_write(chain.self);
 		return;
 	}
 	else if (type.basetype == SPIRType::Struct)
 	{
+		bool coalesced = access_chain_is_coalescable(chain);
+		if (coalesced)
+			coalescing_access_chain_write = true;
 		write_access_chain_struct(chain, value, composite_chain);
+		if (coalesced)
+			end_coalesced_access_chain_write(chain);
 		register_write(chain.self);
 		return;
 	}
@@ -17021,6 +17652,11 @@ void CompilerHLSL::write_access_chain(const SPIRAccessChain &chain, uint32_t val
 		SPIRV_CROSS_THROW("Writing types other than 32-bit to RWByteAddressBuffer not yet supported, unless SM 6.2 and "
 		                  "native 16-bit types are enabled.");
 
+	// Row-major matrices are otherwise stored one scalar at a time.
+	bool coalesced = chain.row_major_matrix && access_chain_is_coalescable(chain);
+	if (coalesced)
+		coalescing_access_chain_write = true;
+
 	bool templated_store = hlsl_options.shader_model >= 62;
 
 	auto base = chain.base;
@@ -17062,8 +17698,7 @@ void CompilerHLSL::write_access_chain(const SPIRAccessChain &chain, uint32_t val
 		}
 		else
 			store_op = "Store";
-		statement(base, ".", store_op, template_expr, "(", chain.dynamic_index, chain.static_index, ", ",
-		          store_expr, ");");
+		write_access_chain_op(base, store_op, template_expr, chain, chain.static_index, type.vecsize, store_expr);
 	}
 	else if (type.columns == 1)
 	{
@@ -17093,8 +17728,8 @@ void CompilerHLSL::write_access_chain(const SPIRAccessChain &chain, uint32_t val
 					store_expr = join(bitcast_op, "(", store_expr, ")");
 			}
 
-			statement(base, ".Store", template_expr, "(", chain.dynamic_index,
-			          chain.static_index + chain.matrix_stride * r, ", ", store_expr, ");");
+			write_access_chain_op(base, "Store", template_expr, chain, chain.static_index + chain.matrix_stride * r, 1,
+			                      store_expr);
 		}
 	}
 	else if (!chain.row_major_matrix)
@@ -17137,8 +17772,8 @@ void CompilerHLSL::write_access_chain(const SPIRAccessChain &chain, uint32_t val
 					store_expr = join(bitcast_op, "(", store_expr, ")");
 			}
 
-			statement(base, ".", store_op, template_expr, "(", chain.dynamic_index,
-			          chain.static_index + c * chain.matrix_stride, ", ", store_expr, ");");
+			write_access_chain_op(base, store_op, template_expr, chain, chain.static_index + c * chain.matrix_stride,
+			                      templated_store ? 1 : type.vecsize, store_expr);
 		}
 	}
 	else
@@ -17161,15 +17796,281 @@ void CompilerHLSL::write_access_chain(const SPIRAccessChain &chain, uint32_t val
 				auto bitcast_op = bitcast_glsl_op(target_type, type);
 				if (!bitcast_op.empty())
 					store_expr = join(bitcast_op, "(", store_expr, ")");
-				statement(base, ".Store", template_expr, "(", chain.dynamic_index,
-				          chain.static_index + c * (type.width / 8) + r * chain.matrix_stride, ", ", store_expr, ");");
+				write_access_chain_op(base, "Store", template_expr, chain,
+				                      chain.static_index + c * (type.width / 8) + r * chain.matrix_stride, 1,
+				                      store_expr);
 			}
 		}
 	}
 
+	if (coalesced)
+		end_coalesced_access_chain_write(chain);
+
 	register_write(chain.self);
 }
 
+string CompilerHLSL::read_access_chain_op(const string &base, const char *load_op, const string &template_expr,
+                                          const SPIRAccessChain &chain, uint32_t offset, uint32_t count)
+{
+	if (!coalesced_access_words.empty())
+	{
+		auto expr = to_coalesced_access_expression(offset, count);
+		if (!expr.empty())
+			return expr;
+	}
+
+	return join(base, ".", load_op, template_expr, "(", chain.dynamic_index, offset, ")");
+}
+
+void CompilerHLSL::write_access_chain_op(const string &base, const char *store_op, const string &template_expr,
+                                         const SPIRAccessChain &chain, uint32_t offset, uint32_t count,
+                                         const string &store_expr)
+{
+	if (coalescing_access_chain_write)
+	{
+		for (uint32_t i = 0; i < count; i++)
+			coalesced_access_words[offset + 4 * i] = { store_expr, i, count };
+	}
+	else
+		statement(base, ".", store_op, template_expr, "(", chain.dynamic_index, offset, ", ", store_expr, ");");
+}
+
+// Gathers the static byte offset of every 32-bit word touched when accessing type at offset,
+// and counts how many Load/Store operations the uncoalesced path would need for it.
+bool CompilerHLSL::collect_access_chain_words(const SPIRType &type, uint32_t offset, uint32_t matrix_stride,
+                                              uint32_t array_stride, bool row_major, SmallVector<uint32_t> &words,
+                                              uint32_t &op_count)
+{
+	// Arbitrary, but keeps the unrolled unpacking reasonably sized.
+	const size_t max_coalesced_words = 64;
+
+	if (!type.array.empty())
+	{
+		// Arrays are unrolled, so we need to know their size up front.
+		if (!type.array_size_literal.back() || type.array.back() == 0)
+			return false;
+
+		auto &parent_type = get<SPIRType>(type.parent_type);
+		uint32_t parent_array_stride = 0;
+		if (!parent_type.array.empty())
+			parent_array_stride = get_decoration(type.parent_type, DecorationArrayStride);
+
+		for (uint32_t i = 0; i < type.array.back(); i++)
+		{
+			if (!collect_access_chain_words(parent_type, offset + i * array_stride, matrix_stride, parent_array_stride,
+			                                row_major, words, op_count))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	else if (type.basetype == SPIRType::Struct)
+	{
+		uint32_t member_count = uint32_t(type.member_types.size());
+		for (uint32_t i = 0; i < member_count; i++)
+		{
+			auto &member_type = get<SPIRType>(type.member_types[i]);
+			uint32_t member_matrix_stride = 0;
+			uint32_t member_array_stride = 0;
+			bool member_row_major = false;
+
+			if (member_type.columns > 1)
+			{
+				member_matrix_stride = type_struct_member_matrix_stride(type, i);
+				member_row_major = has_member_decoration(type.self, i, DecorationRowMajor);
+			}
+
+			if (!member_type.array.empty())
+				member_array_stride = type_struct_member_array_stride(type, i);
+
+			if (!collect_access_chain_words(member_type, offset + type_struct_member_offset(type, i),
+			                                member_matrix_stride, member_array_stride, member_row_major, words,
+			                                op_count))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	else if (type.width != 32)
+		return false;
+
+	if (type.columns == 1 && !row_major)
+	{
+		for (uint32_t r = 0; r < type.vecsize; r++)
+			words.push_back(offset + 4 * r);
+		op_count++;
+	}
+	else if (type.columns == 1)
+	{
+		for (uint32_t r = 0; r < type.vecsize; r++)
+			words.push_back(offset + r * matrix_stride);
+		op_count += type.vecsize;
+	}
+	else if (!row_major)
+	{
+		for (uint32_t c = 0; c < type.columns; c++)
+			for (uint32_t r = 0; r < type.vecsize; r++)
+				words.push_back(offset + c * matrix_stride + 4 * r);
+		op_count += type.columns;
+	}
+	else
+	{
+		for (uint32_t c = 0; c < type.columns; c++)
+			for (uint32_t r = 0; r < type.vecsize; r++)
+				words.push_back(offset + c * 4 + r * matrix_stride);
+		op_count += type.columns * type.vecsize;
+	}
+
+	return words.size() <= max_coalesced_words;
+}
+
+// Splits a set of word offsets into runs of contiguous words which can be serviced by a single Load/Store.
+// A run never straddles a 16-byte boundary.
+static SmallVector<std::pair<uint32_t, uint32_t>> build_coalesced_access_runs(SmallVector<uint32_t> words)
+{
+	SmallVector<std::pair<uint32_t, uint32_t>> runs;
+	sort(begin(words), end(words));
+	words.erase(unique(begin(words), end(words)), end(words));
+
+	for (auto word : words)
+	{
+		if (!runs.empty() && (word & 15) != 0 && runs.back().first + 4 * runs.back().second == word)
+			runs.back().second++;
+		else
+			runs.push_back({ word, 1 });
+	}
+
+	return runs;
+}
+
+bool CompilerHLSL::access_chain_is_coalescable(const SPIRAccessChain &chain)
+{
+	// Templated loads and stores deal with typed data, not just 32-bit words.
+	if (!hlsl_options.coalesce_byte_address_buffer_access || hlsl_options.shader_model >= 62)
+		return false;
+
+	// We're already inside a coalesced access.
+	if (coalescing_access_chain_write || !coalesced_access_words.empty())
+		return false;
+
+	SmallVector<uint32_t> words;
+	uint32_t op_count = 0;
+	if (!collect_access_chain_words(get<SPIRType>(chain.basetype), chain.static_index, chain.matrix_stride,
+	                                chain.array_stride, chain.row_major_matrix, words, op_count))
+	{
+		return false;
+	}
+
+	// Only bother if we actually end up with fewer operations.
+	return build_coalesced_access_runs(std::move(words)).size() < op_count;
+}
+
+bool CompilerHLSL::begin_coalesced_access_chain_read(const SPIRAccessChain &chain)
+{
+	if (!access_chain_is_coalescable(chain))
+		return false;
+
+	SmallVector<uint32_t> words;
+	uint32_t op_count = 0;
+	collect_access_chain_words(get<SPIRType>(chain.basetype), chain.static_index, chain.matrix_stride,
+	                           chain.array_stride, chain.row_major_matrix, words, op_count);
+
+	string base = chain.base;
+	if (has_decoration(chain.self, DecorationNonUniform))
+		convert_non_uniform_expression(base, chain.self);
+
+	static const char *const load_ops[] = { "Load", "Load2", "Load3", "Load4" };
+	for (auto &run : build_coalesced_access_runs(std::move(words)))
+	{
+		auto ident = get_unique_identifier();
+		statement(run.second > 1 ? join("uint", run.second) : "uint", " ", ident, " = ", base, ".",
+		          load_ops[run.second - 1], "(", chain.dynamic_index, run.first, ");");
+
+		for (uint32_t i = 0; i < run.second; i++)
+			coalesced_access_words[run.first + 4 * i] = { ident, i, run.second };
+	}
+
+	return true;
+}
+
+void CompilerHLSL::end_coalesced_access_chain_write(const SPIRAccessChain &chain)
+{
+	SmallVector<uint32_t> words;
+	words.reserve(coalesced_access_words.size());
+	for (auto &word : coalesced_access_words)
+		words.push_back(word.first);
+
+	string base = chain.base;
+	if (has_decoration(chain.self, DecorationNonUniform))
+		convert_non_uniform_expression(base, chain.self);
+
+	static const char *const store_ops[] = { "Store", "Store2", "Store3", "Store4" };
+	for (auto &run : build_coalesced_access_runs(std::move(words)))
+	{
+		statement(base, ".", store_ops[run.second - 1], "(", chain.dynamic_index, run.first, ", ",
+		          to_coalesced_access_expression(run.first, run.second), ");");
+	}
+
+	coalesced_access_words.clear();
+	coalescing_access_chain_write = false;
+}
+
+// Builds a uintN expression of count contiguous words starting at offset out of the coalesced words.
+string CompilerHLSL::to_coalesced_access_expression(uint32_t offset, uint32_t count)
+{
+	SmallVector<string> components;
+
+	uint32_t i = 0;
+	while (i < count)
+	{
+		auto itr = coalesced_access_words.find(offset + 4 * i);
+		if (itr == end(coalesced_access_words))
+			return "";
+
+		// Pick up as many consecutive components of the same expression as possible.
+		auto &word = itr->second;
+		uint32_t num_components = 1;
+		while (i + num_components < count)
+		{
+			auto next_itr = coalesced_access_words.find(offset + 4 * (i + num_components));
+			if (next_itr == end(coalesced_access_words))
+				return "";
+
+			auto &next_word = next_itr->second;
+			if (next_word.expr != word.expr || next_word.component != word.component + num_components)
+				break;
+			num_components++;
+		}
+
+		if (num_components == word.vecsize)
+			components.push_back(word.expr);
+		else
+		{
+			string swizzle;
+			for (uint32_t c = 0; c < num_components; c++)
+				swizzle += index_to_swizzle(word.component + c);
+			components.push_back(join(enclose_expression(word.expr), ".", swizzle));
+		}
+
+		i += num_components;
+	}
+
+	if (components.size() == 1)
+		return components.front();
+
+	string expr = join("uint", count, "(");
+	for (size_t c = 0; c < components.size(); c++)
+	{
+		expr += components[c];
+		if (c + 1 < components.size())
+			expr += ", ";
+	}
+	expr += ")";
+	return expr;
+}
+
 void CompilerHLSL::emit_atomic(const uint32_t *ops, uint32_t length, spv::Op op)
 {
 	const char *atomic_op = nullptr;
@@ -17612,6 +18513,25 @@ void CompilerHLSL::require_texture_query_variant(uint32_t var_id)
 	}
 }
 
+void CompilerHLSL::flatten_buffer_block(VariableID id)
+{
+	auto &var = get<SPIRVariable>(id);
+	auto &type = get<SPIRType>(var.basetype);
+	auto name = to_name(type.self, false);
+	auto &flags = get_decoration_bitset(type.self);
+
+	if (!type.array.empty())
+		SPIRV_CROSS_THROW(name + " is an array of UBOs.");
+	if (type.basetype != SPIRType::Struct)
+		SPIRV_CROSS_THROW(name + " is not a struct.");
+	if (!flags.get(DecorationBlock))
+		SPIRV_CROSS_THROW(name + " is not a block.");
+	if (type.member_types.empty())
+		SPIRV_CROSS_THROW(name + " is an empty struct.");
+
+	flattened_buffer_blocks.insert(id);
+}
+
 VariableID CompilerHLSL::remap_num_workgroups_builtin()
 {
 	update_active_builtins();
@@ -19982,6 +20902,7 @@ std::string CompilerHLSL::convert_separate_image_to_expression(uint32_t id)
 	return to_non_uniform_aware_expression(id);
 }
 
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 string CompilerHLSL::legacy_tex_op(const std::string &op, const SPIRType &imgtype, uint32_t tex)
 {
 	const char *type;
@@ -20097,6 +21018,7 @@ string CompilerHLSL::legacy_tex_op(const std::string &op, const SPIRType &imgtyp
 		SPIRV_CROSS_THROW(join("Unsupported legacy texture op: ", op));
 	}
 }
+#endif // SPIRV_CROSS_NO_LEGACY_TARGETS
 
 bool CompilerHLSL::subpass_input_is_framebuffer_fetch(uint32_t id) const
 {
@@ -20133,6 +21055,7 @@ void CompilerHLSL::emit_sparse_feedback_temporaries(uint32_t result_type_id, uin
 	emit_uninitialized_temporary(return_type.member_types[1], texel_id);
 }
 
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 void CompilerHLSL::emit_spv_amd_shader_ballot_op(uint32_t result_type, uint32_t id, uint32_t eop, const uint32_t *args,
                                                  uint32_t)
 {
@@ -20175,7 +21098,9 @@ void CompilerHLSL::emit_spv_amd_shader_ballot_op(uint32_t result_type, uint32_t
 		break;
 	}
 }
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 void CompilerHLSL::emit_spv_amd_shader_explicit_vertex_parameter_op(uint32_t result_type, uint32_t id, uint32_t eop,
                                                                     const uint32_t *args, uint32_t)
 {
@@ -20199,7 +21124,9 @@ void CompilerHLSL::emit_spv_amd_shader_explicit_vertex_parameter_op(uint32_t res
 		break;
 	}
 }
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 void CompilerHLSL::emit_spv_amd_shader_trinary_minmax_op(uint32_t result_type, uint32_t id, uint32_t eop,
                                                          const uint32_t *args, uint32_t)
 {
@@ -20245,7 +21172,9 @@ void CompilerHLSL::emit_spv_amd_shader_trinary_minmax_op(uint32_t result_type, u
 		break;
 	}
 }
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 void CompilerHLSL::emit_spv_amd_gcn_shader_op(uint32_t result_type, uint32_t id, uint32_t eop, const uint32_t *args,
                                               uint32_t)
 {
@@ -20281,6 +21210,7 @@ void CompilerHLSL::emit_spv_amd_gcn_shader_op(uint32_t result_type, uint32_t id,
 		break;
 	}
 }
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 #else
 CompilerHLSL::ShaderSubgroupSupportHelper::Result::Result()
 {
@@ -20421,6 +21351,51 @@ void CompilerHLSL::write_access_chain(const SPIRAccessChain &, uint32_t ,
 	SPIRV_CROSS_THROW("Invalid call.");
 }
 
+string CompilerHLSL::read_access_chain_op(const string &, const char *, const string &, const SPIRAccessChain &,
+                                          uint32_t, uint32_t)
+{
+	SPIRV_CROSS_INVALID_CALL();
+	SPIRV_CROSS_THROW("Invalid call.");
+}
+
+void CompilerHLSL::write_access_chain_op(const string &, const char *, const string &, const SPIRAccessChain &,
+                                         uint32_t, uint32_t, const string &)
+{
+	SPIRV_CROSS_INVALID_CALL();
+	SPIRV_CROSS_THROW("Invalid call.");
+}
+
+bool CompilerHLSL::collect_access_chain_words(const SPIRType &, uint32_t, uint32_t, uint32_t, bool,
+                                              SmallVector<uint32_t> &, uint32_t &)
+{
+	SPIRV_CROSS_INVALID_CALL();
+	SPIRV_CROSS_THROW("Invalid call.");
+}
+
+bool CompilerHLSL::access_chain_is_coalescable(const SPIRAccessChain &)
+{
+	SPIRV_CROSS_INVALID_CALL();
+	SPIRV_CROSS_THROW("Invalid call.");
+}
+
+bool CompilerHLSL::begin_coalesced_access_chain_read(const SPIRAccessChain &)
+{
+	SPIRV_CROSS_INVALID_CALL();
+	SPIRV_CROSS_THROW("Invalid call.");
+}
+
+void CompilerHLSL::end_coalesced_access_chain_write(const SPIRAccessChain &)
+{
+	SPIRV_CROSS_INVALID_CALL();
+	SPIRV_CROSS_THROW("Invalid call.");
+}
+
+string CompilerHLSL::to_coalesced_access_expression(uint32_t, uint32_t)
+{
+	SPIRV_CROSS_INVALID_CALL();
+	SPIRV_CROSS_THROW("Invalid call.");
+}
+
 void CompilerHLSL::emit_atomic(const uint32_t *, uint32_t , spv::Op )
 {
 	SPIRV_CROSS_INVALID_CALL();
@@ -20439,6 +21414,12 @@ void CompilerHLSL::require_texture_query_variant(uint32_t)
 	SPIRV_CROSS_THROW("Invalid call.");
 }
 
+void CompilerHLSL::flatten_buffer_block(VariableID)
+{
+	SPIRV_CROSS_INVALID_CALL();
+	SPIRV_CROSS_THROW("Invalid call.");
+}
+
 VariableID CompilerHLSL::remap_num_workgroups_builtin()
 {
 	SPIRV_CROSS_INVALID_CALL();
@@ -179,6 +179,33 @@ public:
 		// This relies on UserTypeGOOGLE to encode the buffer type either as "structuredbuffer" or "rwstructuredbuffer"
 		// whereas the type can be extended with an optional subtype, e.g. "structuredbuffer:int".
 		bool preserve_structured_buffers = false;
+
+		// Merges contiguous 32-bit words of composite and row-major matrix ByteAddressBuffer accesses
+		// into wide Load2/3/4 and Store2/3/4 operations which do not straddle a 16-byte boundary.
+		// Loaded words are kept in temporaries and unpacked register-side.
+		// Only applies to SM 6.1 and below, as templated Load<T>() is used for SM 6.2+.
+		bool coalesce_byte_address_buffer_access = false;
+
+		// Emit (RW)StructuredBuffer<T> rather than (RW)ByteAddressBuffer for SSBOs whose only member is a runtime array
+		// laid out exactly like a HLSL structured buffer, i.e. tightly packed 32-bit scalars, vectors, arrays and structs.
+		// Unlike preserve_structured_buffers, this does not rely on UserTypeGOOGLE.
+		// The application must bind a structured buffer view with a stride matching the array stride.
+		bool infer_structured_buffers = false;
+
+		// Emit Buffer<float4>, Buffer<int4> or Buffer<uint4> for read-only SSBOs whose only member is
+		// a runtime array of 32-bit 4-component vectors with a stride of 16.
+		// Loads become single typed buffer fetches. The application must bind a typed view with a matching format.
+		bool infer_typed_buffers = false;
+
+		// Vertex and fragment shader inputs and outputs which are only accessed in the entry point function
+		// are read from and written to SPIRV_Cross_Input and SPIRV_Cross_Output directly,
+		// rather than being copied through static globals in the main() wrapper.
+		bool elide_stage_io_copies = false;
+
+		// Image size, level and sample count queries on non-arrayed resource variables are resolved with
+		// a single GetDimensions() call per resource and LOD at the top of each function which queries it.
+		// Every query in the function reads the cached results rather than calling the spvTextureSize helpers.
+		bool cache_texture_queries = false;
 	};
 
 	struct OptionsGLSL
@@ -253,6 +280,30 @@ public:
 		// compares.
 		bool relax_nan_checks = false;
 
+		// Decide up front which expressions to bind to temporaries based on how often they are read
+		// and how expensive they are to recompute, rather than discovering multiple reads during compilation.
+		// Expensive expressions which are read more than once are always bound to a temporary in the first pass,
+		// saving recompilation passes, while single trivial operations may be duplicated instead.
+		bool materialize_reused_expressions = false;
+
+		// For ES and Vulkan GLSL, infer relaxed precision for the whole module before emitting code.
+		// Values which are only moved around (loads, extracts, constructs and PHIs) become mediump when all their
+		// inputs are mediump, or when every consumer is a RelaxedPrecision operation which would truncate them anyway.
+		// This avoids most of the highp/mediump mirror copies the per-instruction analysis has to introduce.
+		// Arithmetic always keeps the precision declared in SPIR-V.
+		bool infer_relaxed_precision = false;
+
+		// Move loads from UBOs, push constants and non-writable SSBOs out of loops when they provably read
+		// the same value on every iteration, and bind them to a temporary before the loop.
+		// Unoptimized SPIR-V tends to reload such values in every iteration.
+		// Loads with non-constant indices are only hoisted if they execute whenever the loop is entered.
+		bool hoist_loop_invariant_loads = false;
+
+		// Emit switches where every case label only selects constants for variables used after the switch
+		// as a constant lookup table or a chain of ternary selects rather than a switch statement.
+		// Lookup tables are used when there are at least 3 non-negative case labels covering at least half the table.
+		bool lower_constant_switches = false;
+
 		// Loading row-major matrices from UBOs on older AMD Windows OpenGL drivers is problematic.
 		// To load these types correctly, we must generate a wrapper. them in a dummy function which only purpose is to
 		// ensure row_major decoration is actually respected.
@@ -329,6 +380,21 @@ public:
 		hlsl_options = opts;
 	}
 
+	const OptionsGLSL &get_common_options() const
+	{
+		return options;
+	}
+
+	void set_common_options(const OptionsGLSL &opts)
+	{
+		options = opts;
+	}
+
+	// Takes a uniform or push constant variable and flattens it into a (i|u)vec4 array[N]; array instead.
+	// For this to work, all types in the block must be the same basic type, e.g. mixing vec2 and vec4 is fine, but
+	// mixing int and float is not.
+	void flatten_buffer_block(VariableID id);
+
 	// Optionally specify a custom root constant layout.
 	//
 	// Push constants ranges will be split up according to the
@@ -424,6 +490,18 @@ private:
 	void write_access_chain_array(const SPIRAccessChain &chain, uint32_t value,
 	                              const SmallVector<uint32_t> &composite_chain);
 	std::string write_access_chain_value(uint32_t value, const SmallVector<uint32_t> &composite_chain, bool enclose);
+	std::string read_access_chain_op(const std::string &base, const char *load_op, const std::string &template_expr,
+	                                 const SPIRAccessChain &chain, uint32_t offset, uint32_t count);
+	void write_access_chain_op(const std::string &base, const char *store_op, const std::string &template_expr,
+	                           const SPIRAccessChain &chain, uint32_t offset, uint32_t count,
+	                           const std::string &store_expr);
+	bool collect_access_chain_words(const SPIRType &type, uint32_t offset, uint32_t matrix_stride,
+	                                uint32_t array_stride, bool row_major, SmallVector<uint32_t> &words,
+	                                uint32_t &op_count);
+	bool access_chain_is_coalescable(const SPIRAccessChain &chain);
+	bool begin_coalesced_access_chain_read(const SPIRAccessChain &chain);
+	void end_coalesced_access_chain_write(const SPIRAccessChain &chain);
+	std::string to_coalesced_access_expression(uint32_t offset, uint32_t count);
 	void emit_store(const Instruction &instruction);
 	void emit_atomic(const uint32_t *ops, uint32_t length, spv::Op op);
 	void emit_subgroup_op(const Instruction &i);
@@ -441,6 +519,18 @@ private:
 
 	Options hlsl_options;
 
+	// While coalescing a ByteAddressBuffer access, maps the static byte offset of every 32-bit word to the
+	// expression holding it. For reads, this is the temporary which a coalesced Load was stored to,
+	// for writes, the value which will be stored by a coalesced Store.
+	struct CoalescedAccessWord
+	{
+		std::string expr;
+		uint32_t component;
+		uint32_t vecsize;
+	};
+	std::unordered_map<uint32_t, CoalescedAccessWord> coalesced_access_words;
+	bool coalescing_access_chain_write = false;
+
 	// TODO: Refactor this to be more similar to MSL, maybe have some common system in place?
 	bool requires_op_fmod = false;
 	bool requires_fp16_packing = false;
@@ -474,6 +564,22 @@ private:
 	} required_texture_size_variants;
 
 	void require_texture_query_variant(uint32_t var_id);
+
+	// GetDimensions() results which are queried once at function entry, see cache_texture_queries.
+	struct CachedTextureQuery
+	{
+		uint32_t image;
+		uint32_t lod;
+		uint32_t size_id;
+		uint32_t param_id;
+	};
+	std::unordered_map<uint32_t, SmallVector<CachedTextureQuery>> cached_texture_queries;
+	// Every query ever allocated per function, kept across compiles so IDs are only allocated once.
+	std::unordered_map<uint32_t, SmallVector<CachedTextureQuery>> allocated_texture_queries;
+	std::unordered_map<uint32_t, uint32_t> cached_texture_query_results;
+	void analyze_texture_queries();
+	void emit_cached_texture_queries(const SPIRFunction &func);
+	bool emit_cached_texture_query(const uint32_t *ops);
 	void emit_texture_size_variants(uint64_t variant_mask, const char *vecsize_qualifier, bool uav,
 	                                const char *type_qualifier);
 
@@ -551,8 +657,21 @@ private:
 	bool builtin_translates_to_nonarray(spv::BuiltIn builtin) const;
 
 	// Returns true if the specified ID has a UserTypeGOOGLE decoration for StructuredBuffer or RWStructuredBuffer resources.
+	// With infer_structured_buffers or infer_typed_buffers, also returns true for SSBOs which are emitted as such.
 	bool is_user_type_structured(uint32_t id) const;
 
+	// Returns true if the SSBO variable is emitted as a typed Buffer<T> through infer_typed_buffers.
+	bool is_ssbo_typed_buffer(const SPIRVariable &var) const;
+	bool is_ssbo_structured_buffer(const SPIRVariable &var) const;
+	const SPIRType *get_ssbo_runtime_array_type(const SPIRVariable &var) const;
+	bool get_structured_buffer_element_size(const SPIRType &type, uint32_t &size) const;
+
+	// Stage IO variables which are accessed through stage_input and stage_output rather than static globals.
+	std::unordered_set<uint32_t> direct_stage_io_variables;
+	bool direct_stage_input = false;
+	bool direct_stage_output = false;
+	void analyze_direct_stage_io();
+
 	std::vector<TypeID> composite_selection_workaround_types;
 
 	std::string get_inner_entry_point_name() const;
@@ -943,6 +1062,7 @@ private:
 	void emit_line_directive(uint32_t file_id, uint32_t line_literal);
 	void emit_entry_point_declarations();
 	void emit_block_chain(SPIRBlock &block);
+	bool emit_constant_switch(const SPIRBlock &block);
 	void emit_hoisted_temporaries(SmallVector<std::pair<TypeID, ID>> &temporaries);
 	void emit_block_instructions(SPIRBlock &block);
 	void emit_while_loop_initializers(const SPIRBlock &block);
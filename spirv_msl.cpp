@@ -26,6 +26,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <cmath>
 #include <numeric>
 
 using namespace spv;
@@ -45,6 +46,46 @@ enum ExtraSubExpressionType
 	EXTRA_SUB_EXPRESSION_TYPE_AUX = 0x20000000
 };
 
+// Unfortunately we cannot template on the address space, so combinatorial explosion it is.
+enum ArrayCopyVariant
+{
+	ArrayCopyFromConstantToStack = 0,
+	ArrayCopyFromConstantToThreadGroup,
+	ArrayCopyFromStackToStack,
+	ArrayCopyFromStackToThreadGroup,
+	ArrayCopyFromThreadGroupToStack,
+	ArrayCopyFromThreadGroupToThreadGroup,
+	ArrayCopyFromDeviceToDevice,
+	ArrayCopyFromConstantToDevice,
+	ArrayCopyFromStackToDevice,
+	ArrayCopyFromThreadGroupToDevice,
+	ArrayCopyFromDeviceToStack,
+	ArrayCopyFromDeviceToThreadGroup,
+	ArrayCopyVariantCount
+};
+
+static const char *array_copy_function_name_tags[ArrayCopyVariantCount] = {
+	"FromConstantToStack",     "FromConstantToThreadGroup", "FromStackToStack",
+	"FromStackToThreadGroup",  "FromThreadGroupToStack",    "FromThreadGroupToThreadGroup",
+	"FromDeviceToDevice",      "FromConstantToDevice",      "FromStackToDevice",
+	"FromThreadGroupToDevice", "FromDeviceToStack",         "FromDeviceToThreadGroup",
+};
+
+static const char *array_copy_src_address_space[ArrayCopyVariantCount] = {
+	"constant",          "constant",          "thread const", "thread const",
+	"threadgroup const", "threadgroup const", "device const", "constant",
+	"thread const",      "threadgroup const", "device const", "device const",
+};
+
+static const char *array_copy_dst_address_space[ArrayCopyVariantCount] = {
+	"thread", "threadgroup", "thread", "threadgroup", "thread", "threadgroup",
+	"device", "device",      "device", "device",      "thread", "threadgroup",
+};
+
+// Arrays with at most this many elements are copied element by element when both sides
+// live in the same address space, rather than going through a spvArrayCopy helper.
+static const uint32_t k_array_copy_unroll_max = 4;
+
 static string create_sampler_address(const char *prefix, MSLSamplerAddress addr)
 {
 	switch (addr)
@@ -1520,6 +1561,11 @@ string CompilerMSL::compile()
 {
 	replace_illegal_entry_point_names();
 	ir.fixup_reserved_names();
+	validate_compiled_features();
+#ifdef SPIRV_CROSS_NO_TESSELLATION
+	if (msl_options.vertex_for_tessellation)
+		SPIRV_CROSS_THROW("Tessellation support was compiled out (SPIRV_CROSS_NO_TESSELLATION).");
+#endif
 
 	// Do not deal with GLES-isms like precision, older extensions and such.
 	options.vulkan_semantics = true;
@@ -1573,7 +1619,18 @@ string CompilerMSL::compile()
 	replace_illegal_names();
 	sync_entry_point_aliases_and_names();
 
+	restore_loop_invariant_loads();
+	if (options.hoist_loop_invariant_loads)
+		hoist_loop_invariant_loads();
 	build_function_control_flow_graphs_and_analyze();
+	if (options.materialize_reused_expressions)
+		analyze_expression_reuse(temporary_to_mirror_precision_alias);
+	else
+		reset_expression_reuse();
+	if (options.lower_constant_switches)
+		analyze_constant_switches(true);
+	else
+		reset_constant_switches();
 	update_active_builtins();
 	analyze_image_and_sampler_usage();
 	analyze_sampled_image_usage();
@@ -4013,8 +4070,12 @@ void CompilerMSL::mark_scalar_layout_structs(const SPIRType &type)
 					struct_is_too_large = true;
 			}
 
-			if (struct_is_misaligned || struct_is_too_large)
+			if ((struct_is_misaligned || struct_is_too_large) &&
+			    !(msl_options.minimize_packed_struct_members &&
+			      mark_struct_members_packed_minimally(type, i, *struct_type, array_stride)))
+			{
 				mark_struct_members_packed(*struct_type);
+			}
 			mark_scalar_layout_structs(*struct_type);
 
 			if (struct_needs_explicit_padding)
@@ -4920,27 +4981,12 @@ void CompilerMSL::emit_custom_functions()
 		case SPVFuncImplArrayOfArrayCopy5Dim:
 		case SPVFuncImplArrayOfArrayCopy6Dim:
 		{
-			// Unfortunately we cannot template on the address space, so combinatorial explosion it is.
-			static const char *function_name_tags[] = {
-				"FromConstantToStack",     "FromConstantToThreadGroup", "FromStackToStack",
-				"FromStackToThreadGroup",  "FromThreadGroupToStack",    "FromThreadGroupToThreadGroup",
-				"FromDeviceToDevice",      "FromConstantToDevice",      "FromStackToDevice",
-				"FromThreadGroupToDevice", "FromDeviceToStack",         "FromDeviceToThreadGroup",
-			};
-
-			static const char *src_address_space[] = {
-				"constant",          "constant",          "thread const", "thread const",
-				"threadgroup const", "threadgroup const", "device const", "constant",
-				"thread const",      "threadgroup const", "device const", "device const",
-			};
-
-			static const char *dst_address_space[] = {
-				"thread", "threadgroup", "thread", "threadgroup", "thread", "threadgroup",
-				"device", "device",      "device", "device",      "thread", "threadgroup",
-			};
-
-			for (uint32_t variant = 0; variant < 12; variant++)
+			for (uint32_t variant = 0; variant < ArrayCopyVariantCount; variant++)
 			{
+				// Only emit the address space combinations which are actually used.
+				if ((array_copy_variants & (1u << variant)) == 0)
+					continue;
+
 				uint8_t dimensions = spv_func - SPVFuncImplArrayCopyMultidimBase;
 				string tmp = "template<typename T";
 				for (uint8_t i = 0; i < dimensions; i++)
@@ -4959,9 +5005,9 @@ void CompilerMSL::emit_custom_functions()
 					array_arg += "]";
 				}
 
-				statement("inline void spvArrayCopy", function_name_tags[variant], dimensions, "(",
-				          dst_address_space[variant], " T (&dst)", array_arg, ", ", src_address_space[variant],
-				          " T (&src)", array_arg, ")");
+				statement("inline void spvArrayCopy", array_copy_function_name_tags[variant], dimensions, "(",
+				          array_copy_dst_address_space[variant], " T (&dst)", array_arg, ", ",
+				          array_copy_src_address_space[variant], " T (&src)", array_arg, ")");
 
 				begin_scope();
 				statement("for (uint i = 0; i < A; i++)");
@@ -4970,7 +5016,7 @@ void CompilerMSL::emit_custom_functions()
 				if (dimensions == 1)
 					statement("dst[i] = src[i];");
 				else
-					statement("spvArrayCopy", function_name_tags[variant], dimensions - 1, "(dst[i], src[i]);");
+					statement("spvArrayCopy", array_copy_function_name_tags[variant], dimensions - 1, "(dst[i], src[i]);");
 				end_scope();
 				end_scope();
 				statement("");
@@ -8043,6 +8089,7 @@ void CompilerMSL::emit_instruction(const Instruction &instruction)
 			SPIRV_CROSS_THROW("Raster order groups require MSL 2.0.");
 		break; // Nothing to do in the body
 
+#ifndef SPIRV_CROSS_NO_RAY_TRACING
 	case OpConvertUToAccelerationStructureKHR:
 		SPIRV_CROSS_THROW("ConvertUToAccelerationStructure is not supported in MSL.");
 	case OpRayQueryGetIntersectionInstanceShaderBindingTableRecordOffsetKHR:
@@ -8136,6 +8183,7 @@ void CompilerMSL::emit_instruction(const Instruction &instruction)
 #undef MSL_RAY_QUERY_IS_OP2
 #undef MSL_RAY_QUERY_GET_OP2
 #undef MSL_RAY_QUERY_OP_INNER2
+#endif // SPIRV_CROSS_NO_RAY_TRACING
 
 	case OpConvertPtrToU:
 	case OpConvertUToPtr:
@@ -14726,6 +14774,7 @@ void CompilerMSL::reset(uint32_t iteration_count)
 	statement_count = 0;
 	indent = 0;
 	current_loop_level = 0;
+	unpack_conversion_count = 0;
 }
 
 void CompilerMSL::emit_function(SPIRFunction &func, const Bitset &return_flags)
@@ -15016,7 +15065,9 @@ void CompilerMSL::track_expression_read(uint32_t id)
 
 	// If we try to read a forwarded temporary more than once we will stamp out possibly complex code twice.
 	// In this case, it's better to just bind the complex expression to the temporary and read that temporary twice.
-	if (expression_is_forwarded(id) && !expression_suppresses_usage_tracking(id))
+	// Expressions which analyze_expression_reuse() deemed trivial are duplicated on purpose.
+	if (expression_is_forwarded(id) && !expression_suppresses_usage_tracking(id) &&
+	    duplicated_expressions.count(id) == 0)
 	{
 		auto &v = expression_usage_counts[id];
 		v++;
@@ -16601,6 +16652,7 @@ string CompilerMSL::access_chain_internal(uint32_t base, const uint32_t *indices
 				// to consider scalar access chains here.
 				// Cleans up some cases where it's very painful to determine the accurate storage class
 				// since blocks can be partially masked ...
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 				auto *var = maybe_get_backing_variable(base);
 				if (var && var->storage == StorageClassOutput &&
 				    get_execution_model() == ExecutionModelTessellationControl &&
@@ -16608,6 +16660,7 @@ string CompilerMSL::access_chain_internal(uint32_t base, const uint32_t *indices
 				{
 					ignore_potential_sliced_writes = true;
 				}
+#endif
 			}
 			else
 				ignore_potential_sliced_writes = true;
@@ -17353,6 +17406,74 @@ string CompilerMSL::variable_decl_function_local(SPIRVariable &var)
 	return expr;
 }
 
+bool CompilerMSL::emit_constant_switch(const SPIRBlock &block)
+{
+	auto itr = constant_switches.find(block.self);
+	if (itr == end(constant_switches))
+		return false;
+
+	auto &constant_switch = itr->second;
+	bool unsigned_selector = expression_type(block.condition).basetype == SPIRType::UInt;
+	const char *uint_suffix = backend.uint32_t_literal_suffix ? "u" : "";
+
+	const auto to_label = [&](uint32_t literal) -> string {
+		if (unsigned_selector)
+			return join(literal, uint_suffix);
+		else
+			return convert_to_string(int32_t(literal));
+	};
+
+	for (auto &output : constant_switch.outputs)
+	{
+		flush_variable_declaration(output.variable);
+		auto lhs = to_expression(output.variable);
+		const auto to_value = [&](uint32_t value) -> string { return value ? to_expression(value) : lhs; };
+
+		string rhs;
+		if (output.lookup_table)
+		{
+			// Labels outside the table select the default value.
+			auto &table_type = expression_type(output.lookup_table);
+			auto selector = to_expression(block.condition);
+			auto range_check = unsigned_selector ? to_enclosed_expression(block.condition) : join("uint(", selector, ")");
+			rhs = join(range_check, " < ", to_array_size_literal(table_type), uint_suffix, " ? ",
+			           to_expression(output.lookup_table), "[", selector, "] : ", to_value(output.default_value));
+		}
+		else
+		{
+			// Merge labels which select the same value. Labels which select the default value are redundant.
+			SmallVector<uint32_t> values;
+			SmallVector<string> conditions;
+			for (size_t i = 0; i < constant_switch.case_literals.size(); i++)
+			{
+				uint32_t value = output.case_values[i];
+				if (value == output.default_value)
+					continue;
+
+				auto condition = join(to_enclosed_expression(block.condition), " == ",
+				                      to_label(constant_switch.case_literals[i]));
+				auto value_itr = find(begin(values), end(values), value);
+				if (value_itr == end(values))
+				{
+					values.push_back(value);
+					conditions.push_back(std::move(condition));
+				}
+				else
+					conditions[value_itr - begin(values)] += join(" || ", condition);
+			}
+
+			rhs = to_value(output.default_value);
+			for (size_t i = values.size(); i; i--)
+				rhs = join(enclose_expression(conditions[i - 1]), " ? ", to_value(values[i - 1]), " : ", rhs);
+		}
+
+		statement(lhs, " = ", rhs, ";");
+		register_write(output.variable);
+	}
+
+	return true;
+}
+
 void CompilerMSL::emit_block_chain(SPIRBlock &block)
 {
 	bool select_branch_to_true_block = false;
@@ -17570,6 +17691,9 @@ void CompilerMSL::emit_block_chain(SPIRBlock &block)
 
 	case SPIRBlock::MultiSelect:
 	{
+		if (emit_constant_switch(block))
+			break;
+
 		auto &type = expression_type(block.condition);
 		bool unsigned_case = type.basetype == SPIRType::UInt || type.basetype == SPIRType::UShort ||
 		                     type.basetype == SPIRType::UByte || type.basetype == SPIRType::UInt64;
@@ -20243,12 +20367,14 @@ string CompilerMSL::GLSL_builtin_to_glsl(BuiltIn builtin, StorageClass storage)
 		return "gl_Layer";
 	case BuiltInViewportIndex:
 		return "gl_ViewportIndex";
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	case BuiltInTessLevelOuter:
 		return "gl_TessLevelOuter";
 	case BuiltInTessLevelInner:
 		return "gl_TessLevelInner";
 	case BuiltInTessCoord:
 		return "gl_TessCoord";
+#endif
 	case BuiltInFragCoord:
 		return "gl_FragCoord";
 	case BuiltInPointCoord:
@@ -22512,12 +22638,14 @@ void CompilerMSL::GLSL_emit_instruction(const Instruction &instruction)
 		uint32_t id = ops[1];
 		uint32_t img = ops[2];
 		auto &type = expression_type(img);
-		auto &imgtype = get<SPIRType>(type.self);
 
 		std::string fname = "textureSize";
 		if (is_legacy_desktop())
 		{
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
+			auto &imgtype = get<SPIRType>(type.self);
 			fname = legacy_tex_op(fname, imgtype, img);
+#endif
 		}
 		else if (is_legacy_es())
 			SPIRV_CROSS_THROW("textureSize is not supported in ESSL 100.");
@@ -22804,11 +22932,13 @@ void CompilerMSL::GLSL_emit_instruction(const Instruction &instruction)
 			{
 				// This path is hit for samplerBuffers and multisampled images which do not have LOD.
 				std::string fname = "textureSize";
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 				if (is_legacy())
 				{
 					auto &imgtype = get<SPIRType>(type.self);
 					fname = legacy_tex_op(fname, imgtype, ops[2]);
 				}
+#endif
 				expr = join(fname, "(", convert_separate_image_to_expression(ops[2]), ")");
 			}
 
@@ -22854,6 +22984,7 @@ void CompilerMSL::GLSL_emit_instruction(const Instruction &instruction)
 			}
 		}
 
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 		if (execution_scope != ScopeSubgroup && get_entry_point().model == ExecutionModelTessellationControl)
 		{
 			// Control shaders only have barriers, and it implies memory barriers.
@@ -22861,6 +22992,7 @@ void CompilerMSL::GLSL_emit_instruction(const Instruction &instruction)
 				statement("barrier();");
 			break;
 		}
+#endif
 
 		// We only care about these flags, acquire/release and friends are not relevant to GLSL.
 		semantics = mask_relevant_memory_semantics(semantics);
@@ -22997,6 +23129,7 @@ void CompilerMSL::GLSL_emit_instruction(const Instruction &instruction)
 		{
 			emit_glsl_op(ops[0], ops[1], ops[3], &ops[4], length - 4);
 		}
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 		else if (ext == SPIRExtension::SPV_AMD_shader_ballot)
 		{
 			emit_spv_amd_shader_ballot_op(ops[0], ops[1], ops[3], &ops[4], length - 4);
@@ -23013,6 +23146,7 @@ void CompilerMSL::GLSL_emit_instruction(const Instruction &instruction)
 		{
 			emit_spv_amd_gcn_shader_op(ops[0], ops[1], ops[3], &ops[4], length - 4);
 		}
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 		else if (ext == SPIRExtension::SPV_debug_info ||
 		         ext == SPIRExtension::NonSemanticShaderDebugInfo ||
 		         ext == SPIRExtension::NonSemanticGeneric)
@@ -23315,6 +23449,7 @@ void CompilerMSL::GLSL_emit_instruction(const Instruction &instruction)
 		break;
 	}
 
+#ifndef SPIRV_CROSS_NO_RAY_TRACING
 	case OpReportIntersectionKHR:
 		// NV is same opcode.
 		forced_temporaries.insert(ops[1]);
@@ -23442,6 +23577,7 @@ void CompilerMSL::GLSL_emit_instruction(const Instruction &instruction)
 		}
 		break;
 	}
+#endif // SPIRV_CROSS_NO_RAY_TRACING
 
 	case OpConvertUToPtr:
 	{
@@ -23522,9 +23658,11 @@ void CompilerMSL::GLSL_emit_instruction(const Instruction &instruction)
 		}
 		break;
 
+#ifndef SPIRV_CROSS_NO_MESH_SHADING
 	case OpSetMeshOutputsEXT:
 		statement("SetMeshOutputsEXT(", to_unpacked_expression(ops[0]), ", ", to_unpacked_expression(ops[1]), ");");
 		break;
+#endif // SPIRV_CROSS_NO_MESH_SHADING
 
 	case OpReadClockKHR:
 	{
@@ -23590,7 +23728,11 @@ void CompilerMSL::unroll_array_from_complex_load(uint32_t target_id, uint32_t so
 	                  (builtin == BuiltInPointSize ||
 	                   builtin == BuiltInPosition ||
 	                   builtin == BuiltInSampleMask);
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 	bool is_tess = is_tessellation_shader();
+#else
+	bool is_tess = false;
+#endif
 	bool is_patch = has_decoration(var->self, DecorationPatch);
 	bool is_sample_mask = is_builtin && builtin == BuiltInSampleMask;
 
@@ -24605,6 +24747,7 @@ std::string CompilerMSL::convert_separate_image_to_expression(uint32_t id)
 	return to_non_uniform_aware_expression(id);
 }
 
+#ifndef SPIRV_CROSS_NO_LEGACY_TARGETS
 string CompilerMSL::legacy_tex_op(const std::string &op, const SPIRType &imgtype, uint32_t tex)
 {
 	const char *type;
@@ -24720,6 +24863,7 @@ string CompilerMSL::legacy_tex_op(const std::string &op, const SPIRType &imgtype
 		SPIRV_CROSS_THROW(join("Unsupported legacy texture op: ", op));
 	}
 }
+#endif // SPIRV_CROSS_NO_LEGACY_TARGETS
 
 bool CompilerMSL::subpass_input_is_framebuffer_fetch(uint32_t id) const
 {
@@ -24751,6 +24895,7 @@ const Instruction *CompilerMSL::get_next_instruction_in_block(const Instruction
 		return nullptr;
 }
 
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 void CompilerMSL::emit_spv_amd_shader_ballot_op(uint32_t result_type, uint32_t id, uint32_t eop, const uint32_t *args,
                                                  uint32_t)
 {
@@ -24854,6 +24999,7 @@ void CompilerMSL::emit_spv_amd_gcn_shader_op(uint32_t result_type, uint32_t id,
 		break;
 	}
 }
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 
 void CompilerMSL::rewrite_load_for_wrapped_row_major(std::string &expr, TypeID loaded_type, ID ptr)
 {
@@ -25657,6 +25803,7 @@ void CompilerMSL::require_polyfill(Polyfill polyfill, bool relaxed)
 	}
 }
 
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 void CompilerMSL::GLSL_emit_spv_amd_shader_trinary_minmax_op(uint32_t result_type, uint32_t id, uint32_t eop,
                                                          const uint32_t *args, uint32_t)
 {
@@ -25702,6 +25849,7 @@ void CompilerMSL::GLSL_emit_spv_amd_shader_trinary_minmax_op(uint32_t result_typ
 		break;
 	}
 }
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 
 
 void CompilerMSL::emit_nminmax_op(uint32_t result_type, uint32_t id, uint32_t op0, uint32_t op1, GLSLstd450 op)
@@ -26883,6 +27031,11 @@ bool CompilerMSL::has_extension(const std::string &ext) const
 	return itr != end(forced_extensions);
 }
 
+void CompilerMSL::mask_stage_output_by_location(uint32_t location, uint32_t component)
+{
+	masked_output_locations.insert({ location, component });
+}
+
 void CompilerMSL::mask_stage_output_by_builtin(BuiltIn builtin)
 {
 	masked_output_builtins.insert(builtin);
@@ -28415,6 +28568,7 @@ string CompilerMSL::convert_to_f32(const string &expr, uint32_t components)
 	return join(type_to_glsl_constructor(t), "(", expr, ")");
 }
 
+#ifndef SPIRV_CROSS_NO_AMD_EXTENSIONS
 void CompilerMSL::emit_spv_amd_shader_trinary_minmax_op(uint32_t result_type, uint32_t id, uint32_t eop,
                                                         const uint32_t *args, uint32_t count)
 {
@@ -28448,6 +28602,7 @@ void CompilerMSL::emit_spv_amd_shader_trinary_minmax_op(uint32_t result_type, ui
 		break;
 	}
 }
+#endif // SPIRV_CROSS_NO_AMD_EXTENSIONS
 
 // Emits one of the atomic functions. In MSL, the atomic functions operate on pointers
 void CompilerMSL::emit_atomic_func_op(uint32_t result_type, uint32_t result_id, const char *op, Op opcode,
@@ -28792,52 +28947,76 @@ bool CompilerMSL::emit_array_copy(const char *expr, uint32_t lhs_id, uint32_t rh
 			is_constant = true;
 		}
 
-		// For the case where we have OpLoad triggering an array copy,
-		// we cannot easily detect this case ahead of time since it's
-		// context dependent. We might have to force a recompile here
-		// if this is the only use of array copies in our shader.
-		if (type.array.size() > 1)
-		{
-			if (type.array.size() > kArrayCopyMultidimMax)
-				SPIRV_CROSS_THROW("Cannot support this many dimensions for arrays of arrays.");
-			auto func = static_cast<SPVFuncImpl>(SPVFuncImplArrayCopyMultidimBase + type.array.size());
-			add_spv_func_and_recompile(func);
-		}
-		else
-			add_spv_func_and_recompile(SPVFuncImplArrayCopy);
-
-		const char *tag = nullptr;
+		ArrayCopyVariant variant;
 		if (lhs_is_thread_storage && is_constant)
-			tag = "FromConstantToStack";
+			variant = ArrayCopyFromConstantToStack;
 		else if (lhs_storage == StorageClassWorkgroup && is_constant)
-			tag = "FromConstantToThreadGroup";
+			variant = ArrayCopyFromConstantToThreadGroup;
 		else if (lhs_is_thread_storage && rhs_is_thread_storage)
-			tag = "FromStackToStack";
+			variant = ArrayCopyFromStackToStack;
 		else if (lhs_storage == StorageClassWorkgroup && rhs_is_thread_storage)
-			tag = "FromStackToThreadGroup";
+			variant = ArrayCopyFromStackToThreadGroup;
 		else if (lhs_is_thread_storage && rhs_storage == StorageClassWorkgroup)
-			tag = "FromThreadGroupToStack";
+			variant = ArrayCopyFromThreadGroupToStack;
 		else if (lhs_storage == StorageClassWorkgroup && rhs_storage == StorageClassWorkgroup)
-			tag = "FromThreadGroupToThreadGroup";
+			variant = ArrayCopyFromThreadGroupToThreadGroup;
 		else if (lhs_storage == StorageClassStorageBuffer && rhs_storage == StorageClassStorageBuffer)
-			tag = "FromDeviceToDevice";
+			variant = ArrayCopyFromDeviceToDevice;
 		else if (lhs_storage == StorageClassStorageBuffer && is_constant)
-			tag = "FromConstantToDevice";
+			variant = ArrayCopyFromConstantToDevice;
 		else if (lhs_storage == StorageClassStorageBuffer && rhs_storage == StorageClassWorkgroup)
-			tag = "FromThreadGroupToDevice";
+			variant = ArrayCopyFromThreadGroupToDevice;
 		else if (lhs_storage == StorageClassStorageBuffer && rhs_is_thread_storage)
-			tag = "FromStackToDevice";
+			variant = ArrayCopyFromStackToDevice;
 		else if (lhs_storage == StorageClassWorkgroup && rhs_storage == StorageClassStorageBuffer)
-			tag = "FromDeviceToThreadGroup";
+			variant = ArrayCopyFromDeviceToThreadGroup;
 		else if (lhs_is_thread_storage && rhs_storage == StorageClassStorageBuffer)
-			tag = "FromDeviceToStack";
+			variant = ArrayCopyFromDeviceToStack;
 		else
 			SPIRV_CROSS_THROW("Unknown storage class used for copying arrays.");
 
+		// Small one-dimensional arrays within a single address space are simply assigned element by element.
+		// Both spvUnsafeArray<> and native arrays support subscripting, so no helper function is needed at all.
+		bool same_address_space = variant == ArrayCopyFromStackToStack ||
+		                          variant == ArrayCopyFromThreadGroupToThreadGroup ||
+		                          variant == ArrayCopyFromDeviceToDevice;
+		if (same_address_space && type.array.size() == 1 && type.array_size_literal.back() &&
+		    type.array.back() != 0 && type.array.back() <= k_array_copy_unroll_max)
+		{
+			lhs = enclose_expression(lhs);
+			auto rhs = to_enclosed_expression(rhs_id);
+			for (uint32_t i = 0; i < type.array.back(); i++)
+				statement(lhs, "[", i, "] = ", rhs, "[", i, "];");
+			return true;
+		}
+
+		// For the case where we have OpLoad triggering an array copy,
+		// we cannot easily detect this case ahead of time since it's
+		// context dependent. We might have to force a recompile here
+		// if this is the only use of array copies in our shader.
+		if (type.array.size() > 1)
+		{
+			if (type.array.size() > kArrayCopyMultidimMax)
+				SPIRV_CROSS_THROW("Cannot support this many dimensions for arrays of arrays.");
+			auto func = static_cast<SPVFuncImpl>(SPVFuncImplArrayCopyMultidimBase + type.array.size());
+			add_spv_func_and_recompile(func);
+		}
+		else
+			add_spv_func_and_recompile(SPVFuncImplArrayCopy);
+
+		// Only the address space combinations we have seen are emitted as helpers.
+		if ((array_copy_variants & (1u << variant)) == 0)
+		{
+			array_copy_variants |= 1u << variant;
+			force_recompile();
+		}
+
+		const char *tag = array_copy_function_name_tags[variant];
+
 		// Pass internal array of spvUnsafeArray<> into wrapper functions
 		if (lhs_is_array_template && rhs_is_array_template && !msl_options.force_native_arrays)
 			statement("spvArrayCopy", tag, type.array.size(), "(", lhs, ".elements, ", to_expression(rhs_id), ".elements);");
-		if (lhs_is_array_template && !msl_options.force_native_arrays)
+		else if (lhs_is_array_template && !msl_options.force_native_arrays)
 			statement("spvArrayCopy", tag, type.array.size(), "(", lhs, ".elements, ", to_expression(rhs_id), ");");
 		else if (rhs_is_array_template && !msl_options.force_native_arrays)
 			statement("spvArrayCopy", tag, type.array.size(), "(", lhs, ", ", to_expression(rhs_id), ".elements);");
@@ -28857,6 +29036,7 @@ uint32_t CompilerMSL::get_physical_tess_level_array_size(spv::BuiltIn builtin) c
 }
 
 
+#ifndef SPIRV_CROSS_NO_TESSELLATION
 bool CompilerMSL::emit_tessellation_access_chain(const uint32_t *ops, uint32_t length)
 {
 	// If this is a per-vertex output, remap it to the I/O array buffer.
@@ -29497,6 +29677,17 @@ bool CompilerMSL::emit_tessellation_io_load(uint32_t result_type_id, uint32_t id
 	register_read(id, ptr, false);
 	return true;
 }
+#else
+bool CompilerMSL::emit_tessellation_access_chain(const uint32_t *, uint32_t)
+{
+	SPIRV_CROSS_THROW("Tessellation support was compiled out (SPIRV_CROSS_NO_TESSELLATION).");
+}
+
+bool CompilerMSL::emit_tessellation_io_load(uint32_t, uint32_t, uint32_t)
+{
+	SPIRV_CROSS_THROW("Tessellation support was compiled out (SPIRV_CROSS_NO_TESSELLATION).");
+}
+#endif // SPIRV_CROSS_NO_TESSELLATION
 
 void CompilerMSL::emit_binary_ptr_op(uint32_t result_type, uint32_t result_id, uint32_t op0, uint32_t op1, const char *op)
 {
@@ -29562,6 +29753,8 @@ string CompilerMSL::unpack_expression_type(string expr_str, const SPIRType &type
 	if (physical_type_id == 0 && !packed)
 		return expr_str;
 
+	unpack_conversion_count++;
+
 	const SPIRType *physical_type = nullptr;
 	if (physical_type_id)
 		physical_type = &get<SPIRType>(physical_type_id);
@@ -29655,6 +29848,66 @@ void CompilerMSL::mark_struct_members_packed(const SPIRType &type)
 	}
 }
 
+// Instead of packing every member, pack members in order of decreasing alignment until the struct fits
+// at its offset in parent_type and within array_stride. Returns false if the struct cannot be handled this way.
+bool CompilerMSL::mark_struct_members_packed_minimally(const SPIRType &parent_type, uint32_t index,
+                                                       const SPIRType &type, uint32_t array_stride)
+{
+	// Already packed through another use of the same type.
+	if (has_extended_decoration(type.self, SPIRVCrossDecorationPhysicalTypePacked))
+		return true;
+
+	uint32_t mbr_cnt = uint32_t(type.member_types.size());
+	for (uint32_t i = 0; i < mbr_cnt; i++)
+	{
+		// Nested structs would have to be repacked as a whole anyways.
+		auto &mbr_type = get<SPIRType>(type.member_types[i]);
+		if (mbr_type.basetype == SPIRType::Struct || mbr_type.pointer)
+			return false;
+	}
+
+	uint32_t spirv_offset = type_struct_member_offset(parent_type, index);
+	uint32_t spirv_offset_next = 0;
+	if (index + 1 < parent_type.member_types.size())
+		spirv_offset_next = type_struct_member_offset(parent_type, index + 1);
+
+	const auto struct_fits = [&]() -> bool {
+		uint32_t alignment = get_declared_type_alignment_msl(type, false, false);
+		if ((spirv_offset % alignment) != 0)
+			return false;
+		// The padded struct size must also be a multiple of the alignment, or MSL would use a larger array stride.
+		if (array_stride)
+			return (array_stride % alignment) == 0 && get_declared_struct_size_msl(type, false, true) <= array_stride;
+		if (spirv_offset_next)
+			return spirv_offset + get_declared_struct_size_msl(type, false, true) <= spirv_offset_next;
+		return true;
+	};
+
+	while (!struct_fits())
+	{
+		uint32_t max_alignment = 0;
+		for (uint32_t i = 0; i < mbr_cnt; i++)
+			if (!is_scalar(get<SPIRType>(type.member_types[i])) && !member_is_packed_physical_type(type, i))
+				max_alignment = max(max_alignment, get_declared_struct_member_alignment_msl(type, i));
+
+		// Packing everything did not help, let the caller deal with it.
+		if (max_alignment == 0)
+			return false;
+
+		for (uint32_t i = 0; i < mbr_cnt; i++)
+		{
+			if (!is_scalar(get<SPIRType>(type.member_types[i])) && !member_is_packed_physical_type(type, i) &&
+			    get_declared_struct_member_alignment_msl(type, i) == max_alignment)
+			{
+				set_extended_member_decoration(type.self, i, SPIRVCrossDecorationPhysicalTypePacked);
+			}
+		}
+	}
+
+	set_extended_decoration(type.self, SPIRVCrossDecorationPhysicalTypePacked);
+	return true;
+}
+
 uint32_t CompilerMSL::add_interface_block_pointer(uint32_t ib_var_id, StorageClass storage)
 {
 	if (!ib_var_id)
@@ -30978,6 +31231,12 @@ bool CompilerMSL::has_extension(const std::string &) const
 	SPIRV_CROSS_THROW("Invalid call.");
 }
 
+void CompilerMSL::mask_stage_output_by_location(uint32_t, uint32_t)
+{
+	SPIRV_CROSS_INVALID_CALL();
+	SPIRV_CROSS_THROW("Invalid call.");
+}
+
 void CompilerMSL::mask_stage_output_by_builtin(BuiltIn)
 {
 	SPIRV_CROSS_INVALID_CALL();
@@ -31406,6 +31665,12 @@ string CompilerMSL::unpack_expression_type(string, const SPIRType &, uint32_t,
 	SPIRV_CROSS_THROW("Invalid call.");
 }
 
+bool CompilerMSL::mark_struct_members_packed_minimally(const SPIRType &, uint32_t, const SPIRType &, uint32_t)
+{
+	SPIRV_CROSS_INVALID_CALL();
+	SPIRV_CROSS_THROW("Invalid call.");
+}
+
 void CompilerMSL::mark_struct_members_packed(const SPIRType &)
 {
 	SPIRV_CROSS_INVALID_CALL();
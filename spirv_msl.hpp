@@ -532,6 +532,13 @@ public:
 		// Note: Only Apple's GPU compiler takes advantage of the lack of coherency, so make sure to test on Apple GPUs if you disable this.
 		bool readwrite_texture_fences = true;
 
+		// If a struct does not fit the offset or array stride SPIR-V requires, e.g. with scalar block layout,
+		// every vector and matrix member of the struct is normally declared as a packed type.
+		// Packed members must be unpacked on every access and cannot use aligned vector loads.
+		// If set, only the members with the largest alignment are packed, one alignment class at a time,
+		// until the struct fits, e.g. { float4 color; float2 uv; } with a stride of 24 only packs color.
+		bool minimize_packed_struct_members = false;
+
 		bool is_ios() const
 		{
 			return platform == iOS;
@@ -707,6 +714,13 @@ public:
 	// This corresponds to VK_KHR_push_descriptor in Vulkan.
 	void add_discrete_descriptor_set(uint32_t desc_set);
 
+	// If a shader output is active in this stage, but inactive in a subsequent stage,
+	// this can be signalled here. An output which matches one of these will not be emitted
+	// in the stage output interface, but rather treated as a private variable.
+	// Masking builtins only takes effect if the builtin in question is part of the stage output interface.
+	void mask_stage_output_by_location(uint32_t location, uint32_t component);
+	void mask_stage_output_by_builtin(spv::BuiltIn builtin);
+
 	// If an argument buffer is large enough, it may need to be in the device storage space rather than
 	// constant. Opt-in to this behavior here on a per set basis.
 	void set_argument_buffer_device_address_space(uint32_t desc_set, bool device_storage);
@@ -759,6 +773,13 @@ public:
 	// in which case the third plane's binding is returned instead. For any other resource type, -1 is returned.
 	uint32_t get_automatic_msl_resource_binding_quaternary(uint32_t id) const;
 
+	// Query after compilation is done. Reports how many times a packed or remapped physical type
+	// had to be converted to its logical type in the emitted code, e.g. float3(packed_value).
+	uint32_t get_unpack_conversion_count() const
+	{
+		return unpack_conversion_count;
+	}
+
 	// Compiles the SPIR-V code into Metal Shading Language.
 	std::string compile() override;
 
@@ -1083,6 +1104,8 @@ protected:
 	void align_struct(SPIRType &ib_type, std::unordered_set<uint32_t> &aligned_structs);
 	void mark_scalar_layout_structs(const SPIRType &ib_type);
 	void mark_struct_members_packed(const SPIRType &type);
+	bool mark_struct_members_packed_minimally(const SPIRType &parent_type, uint32_t index, const SPIRType &type,
+	                                          uint32_t array_stride);
 	void ensure_member_packing_rules_msl(SPIRType &ib_type, uint32_t index);
 	bool validate_member_packing_rules_msl(const SPIRType &type, uint32_t index) const;
 	std::string get_argument_address_space(const SPIRVariable &argument);
@@ -1163,6 +1186,9 @@ protected:
 
 	Options msl_options;
 	std::set<SPVFuncImpl> spv_function_implementations;
+	// Bitmask of the spvArrayCopy address space combinations in use.
+	uint32_t array_copy_variants = 0;
+	uint32_t unpack_conversion_count = 0;
 	// Must be ordered to ensure declarations are in a specific order.
 	std::map<LocationComponentPair, MSLShaderInterfaceVariable> inputs_by_location;
 	std::unordered_map<uint32_t, MSLShaderInterfaceVariable> inputs_by_builtin;
@@ -1363,6 +1389,7 @@ protected:
 		SortAspect sort_aspect;
 	};
 
+public:
 	// FROM GLSL
 	struct GLSLOptions
 	{
@@ -1436,6 +1463,30 @@ protected:
 		// compares.
 		bool relax_nan_checks = false;
 
+		// Decide up front which expressions to bind to temporaries based on how often they are read
+		// and how expensive they are to recompute, rather than discovering multiple reads during compilation.
+		// Expensive expressions which are read more than once are always bound to a temporary in the first pass,
+		// saving recompilation passes, while single trivial operations may be duplicated instead.
+		bool materialize_reused_expressions = false;
+
+		// For ES and Vulkan GLSL, infer relaxed precision for the whole module before emitting code.
+		// Values which are only moved around (loads, extracts, constructs and PHIs) become mediump when all their
+		// inputs are mediump, or when every consumer is a RelaxedPrecision operation which would truncate them anyway.
+		// This avoids most of the highp/mediump mirror copies the per-instruction analysis has to introduce.
+		// Arithmetic always keeps the precision declared in SPIR-V.
+		bool infer_relaxed_precision = false;
+
+		// Move loads from UBOs, push constants and non-writable SSBOs out of loops when they provably read
+		// the same value on every iteration, and bind them to a temporary before the loop.
+		// Unoptimized SPIR-V tends to reload such values in every iteration.
+		// Loads with non-constant indices are only hoisted if they execute whenever the loop is entered.
+		bool hoist_loop_invariant_loads = false;
+
+		// Emit switches where every case label only selects constants for variables used after the switch
+		// as a constant lookup table or a chain of ternary selects rather than a switch statement.
+		// Lookup tables are used when there are at least 3 non-negative case labels covering at least half the table.
+		bool lower_constant_switches = false;
+
 		// Loading row-major matrices from UBOs on older AMD Windows OpenGL drivers is problematic.
 		// To load these types correctly, we must generate a wrapper. them in a dummy function which only purpose is to
 		// ensure row_major decoration is actually respected.
@@ -1481,6 +1532,17 @@ protected:
 		} fragment;
 	};
 
+	const GLSLOptions &get_common_options() const
+	{
+		return options;
+	}
+
+	void set_common_options(const GLSLOptions &opts)
+	{
+		options = opts;
+	}
+
+protected:
 	GLSLOptions options;
 
 	struct ShaderSubgroupSupportHelper
@@ -1784,7 +1846,6 @@ protected:
 	std::string convert_double_to_string(const SPIRConstant &value, uint32_t col, uint32_t row);
 	void require_extension_internal(const std::string &ext);
 	bool has_extension(const std::string &ext) const;
-	void mask_stage_output_by_builtin(spv::BuiltIn builtin);
 	std::string to_unpacked_row_major_matrix_expression(uint32_t id);
 	std::string to_unpacked_expression(uint32_t id, bool register_expression_read = true);
 	std::string to_dereferenced_expression(uint32_t id, bool register_expression_read = true);
@@ -1885,6 +1946,7 @@ protected:
 	void emit_line_directive(uint32_t file_id, uint32_t line_literal);
 	std::string variable_decl_function_local(SPIRVariable &variable);
 	void emit_block_chain(SPIRBlock &block);
+	bool emit_constant_switch(const SPIRBlock &block);
 	bool is_stage_output_location_masked(uint32_t location, uint32_t component) const;
 	bool remove_duplicate_swizzle(std::string &op);
 	void emit_hoisted_temporaries(SmallVector<std::pair<TypeID, ID>> &temporaries);
@@ -108,15 +108,15 @@ void Parser::parse()
 	{
 		Instruction instr = {};
 		instr.op = spirv[offset] & 0xffff;
-		instr.count = (spirv[offset] >> 16) & 0xffff;
+		uint32_t count = (spirv[offset] >> 16) & 0xffff;
 
-		if (instr.count == 0)
+		if (count == 0)
 			SPIRV_CROSS_THROW("SPIR-V instructions cannot consume 0 words. Invalid SPIR-V file.");
 
 		instr.offset = offset + 1;
-		instr.length = instr.count - 1;
+		instr.length = uint16_t(count - 1);
 
-		offset += instr.count;
+		offset += count;
 
 		if (offset > spirv.size())
 			SPIRV_CROSS_THROW("SPIR-V instruction goes out of bounds.");
@@ -737,13 +737,20 @@ void Parser::parse(const Instruction &instruction)
 		// For stripped names, never consider struct type aliasing.
 		// We risk declaring the same struct multiple times, but type-punning is not allowed
 		// so this is safe.
-		bool consider_aliasing = !ir.get_name(type.self).empty();
+		auto &name = ir.get_name(type.self);
+		bool consider_aliasing = !name.empty();
 		if (consider_aliasing)
 		{
-			for (auto &other : global_struct_cache)
+			// Logically equivalent types always hash equally, so only one bucket needs to be searched.
+			Hasher hasher;
+			for (auto c : name)
+				hasher.u32(uint8_t(c));
+			hash_type_structure(hasher, type);
+
+			auto &candidates = global_struct_cache[hasher.get()];
+			for (auto &other : candidates)
 			{
-				if (ir.get_name(type.self) == ir.get_name(other) &&
-				    types_are_logically_equivalent(type, get<SPIRType>(other)))
+				if (name == ir.get_name(other) && types_are_logically_equivalent(type, get<SPIRType>(other)))
 				{
 					type.type_alias = other;
 					break;
@@ -751,7 +758,7 @@ void Parser::parse(const Instruction &instruction)
 			}
 
 			if (type.type_alias == TypeID(0))
-				global_struct_cache.push_back(id);
+				candidates.push_back(id);
 		}
 		break;
 	}
@@ -1310,6 +1317,34 @@ bool Parser::types_are_logically_equivalent(const SPIRType &a, const SPIRType &b
 	return true;
 }
 
+// Hashes exactly what types_are_logically_equivalent() compares.
+void Parser::hash_type_structure(Hasher &hasher, const SPIRType &type) const
+{
+	hasher.u32(type.basetype);
+	hasher.u32(type.width);
+	hasher.u32(type.vecsize);
+	hasher.u32(type.columns);
+	hasher.u32(uint32_t(type.array.size()));
+	for (auto &dim : type.array)
+		hasher.u32(dim);
+
+	if (type.basetype == SPIRType::Image || type.basetype == SPIRType::SampledImage)
+	{
+		hasher.u32(type.image.type);
+		hasher.u32(type.image.dim);
+		hasher.u32(type.image.depth);
+		hasher.u32(type.image.arrayed);
+		hasher.u32(type.image.ms);
+		hasher.u32(type.image.sampled);
+		hasher.u32(type.image.format);
+		hasher.u32(type.image.access);
+	}
+
+	hasher.u32(uint32_t(type.member_types.size()));
+	for (auto &member : type.member_types)
+		hash_type_structure(hasher, get<SPIRType>(member));
+}
+
 bool Parser::variable_storage_is_aliased(const SPIRVariable &v) const
 {
 	auto &type = get<SPIRType>(v.basetype);
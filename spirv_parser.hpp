@@ -91,11 +91,13 @@ private:
 			return nullptr;
 	}
 
-	// This must be an ordered data structure so we always pick the same type aliases.
-	SmallVector<uint32_t> global_struct_cache;
+	// Named struct types which are candidates for type aliasing, bucketed by name and structural hash.
+	// Buckets must be ordered so we always pick the same type aliases.
+	std::unordered_map<uint64_t, SmallVector<uint32_t>> global_struct_cache;
 	SmallVector<std::pair<uint32_t, uint32_t>> forward_pointer_fixups;
 
 	bool types_are_logically_equivalent(const SPIRType &a, const SPIRType &b) const;
+	void hash_type_structure(Hasher &hasher, const SPIRType &type) const;
 	bool variable_storage_is_aliased(const SPIRVariable &v) const;
 };
 } // namespace SPIRV_CROSS_NAMESPACE
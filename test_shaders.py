@@ -29,15 +29,57 @@ import codecs
 import json
 import multiprocessing
 import errno
+import struct
 from functools import partial
 
 class Paths():
-    def __init__(self, spirv_cross, glslang, spirv_as, spirv_val, spirv_opt):
+    def __init__(self, spirv_cross, glslang, spirv_as, spirv_val, spirv_opt, spirv_cross_server = False):
         self.spirv_cross = spirv_cross
         self.glslang = glslang
         self.spirv_as = spirv_as
         self.spirv_val = spirv_val
         self.spirv_opt = spirv_opt
+        self.spirv_cross_server = spirv_cross_server
+
+# Persistent spirv-cross --server processes, one per executable path and worker process.
+spirv_cross_servers = {}
+
+def call_spirv_cross(args, paths):
+    if not paths.spirv_cross_server:
+        subprocess.check_call(args)
+        return
+
+    server = spirv_cross_servers.get(args[0])
+    if server is None or server.poll() is not None:
+        server = subprocess.Popen([args[0], '--server'], stdin = subprocess.PIPE, stdout = subprocess.PIPE)
+        spirv_cross_servers[args[0]] = server
+
+    request = struct.pack('=I', len(args) - 1)
+    for arg in args[1:]:
+        arg = arg.encode('utf-8')
+        request += struct.pack('=I', len(arg)) + arg
+    request += struct.pack('=I', 0)
+
+    try:
+        server.stdin.write(request)
+        server.stdin.flush()
+        reply = server.stdout.read(8)
+    except BrokenPipeError:
+        reply = b''
+
+    # Some fatal argument errors exit the server, it is restarted on the next call.
+    if len(reply) != 8:
+        server.wait()
+        del spirv_cross_servers[args[0]]
+        raise subprocess.CalledProcessError(server.returncode, args)
+
+    status, output_size = struct.unpack('=II', reply)
+    output = server.stdout.read(output_size)
+    if output:
+        sys.stdout.buffer.write(output)
+        sys.stdout.flush()
+    if status != 0:
+        raise subprocess.CalledProcessError(status, args)
 
 def remove_file(path):
     #print('Removing file:', path)
@@ -359,6 +401,8 @@ def cross_compile_msl(shader, spirv, opt, iterations, paths):
         msl_args.append('--msl-decoration-binding')
     if '.rich-descriptor.' in shader:
         msl_args.append('--msl-runtime-array-rich-descriptor')
+    if '.minimize-packing.' in shader:
+        msl_args.append('--msl-minimize-packed-struct-members')
     if '.mask-location-0.' in shader:
         msl_args.append('--mask-stage-output-location')
         msl_args.append('0')
@@ -378,8 +422,14 @@ def cross_compile_msl(shader, spirv, opt, iterations, paths):
         msl_args.append('ClipDistance')
     if '.relax-nan.' in shader:
         msl_args.append('--relax-nan-checks')
+    if '.materialize-reuse.' in shader:
+        msl_args.append('--materialize-reused-expressions')
+    if '.hoist-loads.' in shader:
+        msl_args.append('--hoist-loop-invariant-loads')
+    if '.lower-switch.' in shader:
+        msl_args.append('--lower-constant-switches')
 
-    subprocess.check_call(msl_args)
+    call_spirv_cross(msl_args, paths)
 
     if not shader_is_invalid_spirv(msl_path):
         subprocess.check_call([paths.spirv_val, '--allow-localsizeid', '--scalar-block-layout', '--target-env', spirv_env, spirv_path])
@@ -520,12 +570,28 @@ def cross_compile_hlsl(shader, spirv, opt, force_no_external_validation, iterati
         hlsl_args.append('--hlsl-flatten-matrix-vertex-input-semantics')
     if '.relax-nan.' in shader:
         hlsl_args.append('--relax-nan-checks')
+    if '.materialize-reuse.' in shader:
+        hlsl_args.append('--materialize-reused-expressions')
+    if '.hoist-loads.' in shader:
+        hlsl_args.append('--hoist-loop-invariant-loads')
+    if '.lower-switch.' in shader:
+        hlsl_args.append('--lower-constant-switches')
     if '.structured.' in shader:
         hlsl_args.append('--hlsl-preserve-structured-buffers')
+    if '.coalesce.' in shader:
+        hlsl_args.append('--hlsl-coalesce-byte-address-buffer-access')
+    if '.infer-structured.' in shader:
+        hlsl_args.append('--hlsl-infer-structured-buffers')
+    if '.infer-typed.' in shader:
+        hlsl_args.append('--hlsl-infer-typed-buffers')
+    if '.elide-io.' in shader:
+        hlsl_args.append('--hlsl-elide-stage-io-copies')
+    if '.cache-queries.' in shader:
+        hlsl_args.append('--hlsl-cache-texture-queries')
     if '.flip-vert-y.' in shader:
         hlsl_args.append('--flip-vert-y')
 
-    subprocess.check_call(hlsl_args)
+    call_spirv_cross(hlsl_args, paths)
 
     if not shader_is_invalid_spirv(hlsl_path):
         subprocess.check_call([paths.spirv_val, '--allow-localsizeid', '--scalar-block-layout', '--target-env', spirv_env, spirv_path])
@@ -553,7 +619,7 @@ def cross_compile_reflect(shader, spirv, opt, iterations, paths):
     spirv_cross_path = paths.spirv_cross
 
     sm = shader_to_sm(shader)
-    subprocess.check_call([spirv_cross_path, '--entry', 'main', '--output', reflect_path, spirv_path, '--reflect', '--iterations', str(iterations)])
+    call_spirv_cross([spirv_cross_path, '--entry', 'main', '--output', reflect_path, spirv_path, '--reflect', '--iterations', str(iterations)], paths)
     return (spirv_path, reflect_path)
 
 def validate_shader(shader, vulkan, paths):
@@ -637,12 +703,20 @@ def cross_compile(shader, vulkan, spirv, invalid_spirv, eliminate, is_legacy, fo
         extra_args += ['--glsl-force-flattened-io-blocks']
     if '.relax-nan.' in shader:
         extra_args.append('--relax-nan-checks')
+    if '.materialize-reuse.' in shader:
+        extra_args.append('--materialize-reused-expressions')
+    if '.hoist-loads.' in shader:
+        extra_args.append('--hoist-loop-invariant-loads')
+    if '.lower-switch.' in shader:
+        extra_args.append('--lower-constant-switches')
+    if '.infer-precision.' in shader:
+        extra_args.append('--glsl-infer-relaxed-precision')
 
     spirv_cross_path = paths.spirv_cross
 
     # A shader might not be possible to make valid GLSL from, skip validation for this case.
     if (not ('nocompat' in glsl_path)) or (not vulkan):
-        subprocess.check_call([spirv_cross_path, '--entry', 'main', '--output', glsl_path, spirv_path] + extra_args)
+        call_spirv_cross([spirv_cross_path, '--entry', 'main', '--output', glsl_path, spirv_path] + extra_args, paths)
         if not 'nocompat' in glsl_path:
             validate_shader(glsl_path, False, paths)
     else:
@@ -650,7 +724,7 @@ def cross_compile(shader, vulkan, spirv, invalid_spirv, eliminate, is_legacy, fo
         glsl_path = None
 
     if (vulkan or spirv) and (not is_legacy):
-        subprocess.check_call([spirv_cross_path, '--entry', 'main', '-V', '--output', vulkan_glsl_path, spirv_path] + extra_args)
+        call_spirv_cross([spirv_cross_path, '--entry', 'main', '-V', '--output', vulkan_glsl_path, spirv_path] + extra_args, paths)
         validate_shader(vulkan_glsl_path, True, paths)
         # SPIR-V shaders might just want to validate Vulkan GLSL output, we don't always care about the output.
         if not vulkan:
@@ -906,10 +980,58 @@ def test_shader_reflect(stats, shader, args, paths):
     regression_check_reflect(shader, reflect, args)
     remove_file(spirv)
 
+# Only produces the SPIR-V the backend would be tested with, for spirv-cross-regression-runner.
+# The result is placed in args.emit_spirv as relpath + '.spv' and is only regenerated when the shader changes.
+def emit_spirv(shader, args, backend, paths):
+    joined_path = os.path.join(shader[0], shader[1])
+    spirv_path = os.path.join(args.emit_spirv, shader[1] + '.spv')
+    if os.path.exists(spirv_path) and os.path.getmtime(spirv_path) >= os.path.getmtime(joined_path):
+        return
+
+    print('Emitting SPIR-V for shader:', joined_path)
+    invalid_spirv = shader_is_invalid_spirv(shader[1])
+    opt = args.opt and (not shader_is_noopt(shader[1]))
+
+    if '.spv16.' in shader[1]:
+        spirv_env = 'spv1.6'
+        glslang_env = 'spirv1.6'
+    elif '.spv14.' in shader[1]:
+        spirv_env = 'vulkan1.1spv1.4'
+        glslang_env = 'spirv1.4'
+    else:
+        spirv_env = 'vulkan1.1'
+        glslang_env = 'vulkan1.1'
+
+    temp_path = create_temporary()
+    if shader_is_spirv(shader[1]):
+        spirv_cmd = [paths.spirv_as, '--preserve-numeric-ids', '--target-env', spirv_env, '-o', temp_path, joined_path]
+    else:
+        spirv_cmd = [paths.glslang, '--amb', '--target-env', glslang_env, '-V', '-o', temp_path, joined_path]
+        if backend == 'glsl' and '.g.' in shader[1]:
+            spirv_cmd.append('-g')
+        if backend == 'glsl' and '.gV.' in shader[1]:
+            spirv_cmd.append('-gV')
+    subprocess.check_call(spirv_cmd)
+
+    if opt and (not invalid_spirv):
+        opt_cmd = [paths.spirv_opt, '--skip-validation', '-O', '-o', temp_path, temp_path]
+        if backend == 'msl' and '.graphics-robust-access.' in shader[1]:
+            opt_cmd.insert(3, '--graphics-robust-access')
+        subprocess.check_call(opt_cmd)
+
+    if not invalid_spirv:
+        subprocess.check_call([paths.spirv_val, '--allow-localsizeid', '--scalar-block-layout', '--target-env', spirv_env, temp_path])
+
+    # Move into place last so an interrupted run never leaves an up-to-date looking file behind.
+    make_reference_dir(spirv_path)
+    shutil.move(temp_path, spirv_path)
+
 def test_shader_file(relpath, stats, args, backend):
-    paths = Paths(args.spirv_cross, args.glslang, args.spirv_as, args.spirv_val, args.spirv_opt)
+    paths = Paths(args.spirv_cross, args.glslang, args.spirv_as, args.spirv_val, args.spirv_opt, args.spirv_cross_server)
     try:
-        if backend == 'msl':
+        if args.emit_spirv:
+            emit_spirv((args.folder, relpath), args, backend, paths)
+        elif backend == 'msl':
             test_shader_msl(stats, (args.folder, relpath), args, paths)
         elif backend == 'hlsl':
             test_shader_hlsl(stats, (args.folder, relpath), args, paths)
@@ -979,6 +1101,9 @@ def main():
     parser.add_argument('--malisc',
             action = 'store_true',
             help = 'Use malisc offline compiler to determine static cycle counts before and after spirv-cross.')
+    parser.add_argument('--glsl',
+            action = 'store_true',
+            help = 'Test GLSL backend. This is the default.')
     parser.add_argument('--msl',
             action = 'store_true',
             help = 'Test Metal backend.')
@@ -1019,6 +1144,12 @@ def main():
             default = 1,
             type = int,
             help = 'Number of iterations to run SPIRV-Cross (benchmarking)')
+    parser.add_argument('--emit-spirv',
+            default = None,
+            help = 'Only compile or assemble the shaders to SPIR-V into this folder, for spirv-cross-regression-runner. SPIRV-Cross is not run.')
+    parser.add_argument('--spirv-cross-server',
+            action = 'store_true',
+            help = 'Run each spirv-cross invocation through a persistent spirv-cross --server process instead of spawning one process per invocation.')
 
     args = parser.parse_args()
     if not args.folder:
@@ -0,0 +1,169 @@
+// Checks that every allocation made by the C API is routed through the context's allocation callbacks.
+// An outer AllocationScope catches allocations that are made outside of the context's own scope.
+
+#include <spirv_cross_c.h>
+#include "spirv_cross_containers.hpp"
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace SPIRV_CROSS_NAMESPACE;
+
+#define SPVC_CHECKED_CALL(x) do { \
+	if ((x) != SPVC_SUCCESS) { \
+		fprintf(stderr, "Failed at line %d.\n", __LINE__); \
+		exit(1); \
+	} \
+} while(0)
+
+struct AllocationCounter
+{
+	size_t allocations = 0;
+	size_t live_bytes = 0;
+	size_t peak_bytes = 0;
+};
+
+// Stores the size in front of the returned block so frees can be accounted for.
+union SizeHeader
+{
+	size_t size;
+	max_align_t align;
+};
+
+static void *counting_allocate(void *userdata, size_t size)
+{
+	auto *counter = static_cast<AllocationCounter *>(userdata);
+	auto *header = static_cast<SizeHeader *>(malloc(size + sizeof(SizeHeader)));
+	if (!header)
+		return nullptr;
+
+	header->size = size;
+	counter->allocations++;
+	counter->live_bytes += size;
+	if (counter->live_bytes > counter->peak_bytes)
+		counter->peak_bytes = counter->live_bytes;
+	return header + 1;
+}
+
+static void counting_free(void *userdata, void *ptr)
+{
+	auto *counter = static_cast<AllocationCounter *>(userdata);
+	auto *header = static_cast<SizeHeader *>(ptr) - 1;
+	counter->live_bytes -= header->size;
+	free(header);
+}
+
+static std::vector<SpvId> read_file(const char *path)
+{
+	long len;
+	FILE *file = fopen(path, "rb");
+
+	if (!file)
+		return {};
+
+	fseek(file, 0, SEEK_END);
+	len = ftell(file);
+	rewind(file);
+
+	std::vector<SpvId> buffer(len / sizeof(SpvId));
+	if (fread(buffer.data(), 1, len, file) != (size_t)len)
+	{
+		fclose(file);
+		return {};
+	}
+
+	fclose(file);
+	return buffer;
+}
+
+static void exercise_compiler(spvc_context ctx, spvc_parsed_ir parsed_ir, spvc_backend backend)
+{
+	spvc_compiler compiler;
+	SPVC_CHECKED_CALL(spvc_context_create_compiler(ctx, backend, parsed_ir, SPVC_CAPTURE_MODE_COPY, &compiler));
+
+	spvc_compiler_options opts;
+	SPVC_CHECKED_CALL(spvc_compiler_create_compiler_options(compiler, &opts));
+	if (backend == SPVC_BACKEND_MSL)
+		SPVC_CHECKED_CALL(spvc_compiler_options_set_uint(opts, SPVC_COMPILER_OPTION_MSL_VERSION, 20000));
+	else
+		SPVC_CHECKED_CALL(spvc_compiler_options_set_uint(opts, SPVC_COMPILER_OPTION_GLSL_VERSION, 450));
+	SPVC_CHECKED_CALL(spvc_compiler_install_compiler_options(compiler, opts));
+
+	spvc_resources resources;
+	const spvc_reflected_resource *list;
+	size_t count;
+	SPVC_CHECKED_CALL(spvc_compiler_create_shader_resources(compiler, &resources));
+	SPVC_CHECKED_CALL(spvc_resources_get_resource_list_for_type(resources, SPVC_RESOURCE_TYPE_UNIFORM_BUFFER, &list, &count));
+
+	for (size_t i = 0; i < count; i++)
+	{
+		spvc_compiler_set_name(compiler, list[i].id, "renamed_block");
+		spvc_compiler_set_decoration(compiler, list[i].id, SpvDecorationBinding, unsigned(i + 4));
+		spvc_compiler_set_member_name(compiler, list[i].base_type_id, 0, "renamed_member");
+		spvc_compiler_set_member_decoration(compiler, list[i].base_type_id, 0, SpvDecorationRelaxedPrecision, 0);
+
+		if (backend == SPVC_BACKEND_MSL)
+		{
+			spvc_msl_resource_binding binding;
+			spvc_msl_resource_binding_init(&binding);
+			binding.stage = spvc_compiler_get_execution_model(compiler);
+			binding.desc_set = spvc_compiler_get_decoration(compiler, list[i].id, SpvDecorationDescriptorSet);
+			binding.binding = unsigned(i + 4);
+			binding.msl_buffer = unsigned(i);
+			SPVC_CHECKED_CALL(spvc_compiler_msl_add_resource_binding(compiler, &binding));
+		}
+	}
+
+	if (backend == SPVC_BACKEND_GLSL)
+		SPVC_CHECKED_CALL(spvc_compiler_add_header_line(compiler, "// Allocation test"));
+
+	const char *str;
+	SPVC_CHECKED_CALL(spvc_compiler_compile(compiler, &str));
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 2)
+		return EXIT_FAILURE;
+
+	auto buffer = read_file(argv[1]);
+	if (buffer.empty())
+		return EXIT_FAILURE;
+
+	AllocationCounter stray, counter;
+	AllocationCallbacks stray_callbacks = { &stray, counting_allocate, counting_free };
+	spvc_allocation_callbacks callbacks = { &counter, counting_allocate, counting_free };
+
+	{
+		AllocationScope scope(&stray_callbacks);
+
+		spvc_context ctx;
+		spvc_parsed_ir parsed_ir;
+		SPVC_CHECKED_CALL(spvc_context_create_with_allocator(&callbacks, &ctx));
+		SPVC_CHECKED_CALL(spvc_context_parse_spirv(ctx, buffer.data(), buffer.size(), &parsed_ir));
+		exercise_compiler(ctx, parsed_ir, SPVC_BACKEND_GLSL);
+		exercise_compiler(ctx, parsed_ir, SPVC_BACKEND_MSL);
+		spvc_context_destroy(ctx);
+	}
+
+	fprintf(stderr, "Context allocations: %zu, peak: %zu bytes, stray allocations: %zu.\n",
+	        counter.allocations, counter.peak_bytes, stray.allocations);
+
+	if (stray.allocations != 0)
+	{
+		fprintf(stderr, "Allocations bypassed the context's callbacks.\n");
+		return EXIT_FAILURE;
+	}
+
+	if (counter.allocations == 0)
+	{
+		fprintf(stderr, "No allocations reached the context's callbacks.\n");
+		return EXIT_FAILURE;
+	}
+
+	if (counter.live_bytes != 0)
+	{
+		fprintf(stderr, "%zu bytes were not freed when the context was destroyed.\n", counter.live_bytes);
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,105 @@
+// Checks that options which rewrite the IR or force temporaries do not leak into a later compile()
+// of the same compiler.
+
+#include "spirv_glsl.hpp"
+#include "spirv_parser.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using namespace spirv_cross;
+
+static std::vector<uint32_t> read_file(const char *path)
+{
+	long len;
+	FILE *file = fopen(path, "rb");
+
+	if (!file)
+		return {};
+
+	fseek(file, 0, SEEK_END);
+	len = ftell(file);
+	rewind(file);
+
+	std::vector<uint32_t> buffer(len / sizeof(uint32_t));
+	if (fread(buffer.data(), 1, len, file) != (size_t)len)
+	{
+		fclose(file);
+		return {};
+	}
+
+	fclose(file);
+	return buffer;
+}
+
+static ParsedIR parse(const std::vector<uint32_t> &spirv)
+{
+	Parser parser(spirv);
+	parser.parse();
+	return std::move(parser.get_parsed_ir());
+}
+
+static void set_options(CompilerGLSL &compiler)
+{
+	auto options = compiler.get_common_options();
+	options.vulkan_semantics = true;
+	compiler.set_common_options(options);
+}
+
+// Compiles twice with every option which rewrites the IR or forces temporaries, then again without them.
+// Only GLSL supports this, CompilerMSL adds its interface blocks to the IR in compile().
+static bool check_recompile(const std::vector<std::vector<uint32_t>> &modules)
+{
+	for (size_t i = 0; i < modules.size(); i++)
+	{
+		CompilerGLSL fresh(parse(modules[i]));
+		set_options(fresh);
+		auto expected = fresh.compile();
+
+		CompilerGLSL compiler(parse(modules[i]));
+		set_options(compiler);
+		auto options = compiler.get_common_options();
+		auto rewriting_options = options;
+		rewriting_options.hoist_loop_invariant_loads = true;
+		rewriting_options.lower_constant_switches = true;
+		rewriting_options.materialize_reused_expressions = true;
+		rewriting_options.infer_relaxed_precision = true;
+		compiler.set_common_options(rewriting_options);
+		auto rewritten = compiler.compile();
+		if (compiler.compile() != rewritten)
+		{
+			fprintf(stderr, "GLSL: output of module %u differs when compiled twice.\n", unsigned(i));
+			return false;
+		}
+
+		compiler.set_common_options(options);
+		if (compiler.compile() != expected)
+		{
+			fprintf(stderr, "GLSL: output of module %u differs when compiled again with other options.\n",
+			        unsigned(i));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+		return EXIT_FAILURE;
+
+	std::vector<std::vector<uint32_t>> modules;
+	for (int i = 1; i < argc; i++)
+	{
+		auto buffer = read_file(argv[i]);
+		if (buffer.empty())
+			return EXIT_FAILURE;
+		modules.push_back(std::move(buffer));
+	}
+
+	if (!check_recompile(modules))
+		return EXIT_FAILURE;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,279 @@
+// In-process regression runner.
+// Compiles pre-assembled SPIR-V for every shader in a test folder with the configurations test_shaders.py
+// derives from the file names, and compares the results against reference/ on a pool of threads.
+// The SPIR-V is produced once with "test_shaders.py --emit-spirv", so no external tool or SPIRV-Cross
+// process is spawned per shader.
+
+#include "regression_runner.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+static bool read_file(const std::string &path, std::string &data)
+{
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	long len = ftell(file);
+	rewind(file);
+
+	data.resize(size_t(len));
+	bool ok = fread(&data[0], 1, data.size(), file) == data.size();
+	fclose(file);
+	return ok;
+}
+
+static std::vector<uint32_t> read_spirv(const std::string &path)
+{
+	std::string data;
+	if (!read_file(path, data))
+		return {};
+
+	std::vector<uint32_t> spirv(data.size() / sizeof(uint32_t));
+	memcpy(spirv.data(), data.data(), spirv.size() * sizeof(uint32_t));
+	return spirv;
+}
+
+// References are compared like md5_for_file() in test_shaders.py does, ignoring carriage returns.
+static std::string strip_carriage_returns(std::string text)
+{
+	text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+	return text;
+}
+
+// Recursively collects all files below a directory relative to it, in a stable order. Hidden files are skipped.
+static bool walk_shader_directory(const std::string &root, const std::string &relpath, std::vector<std::string> &shaders)
+{
+	std::string dir = relpath.empty() ? root : root + "/" + relpath;
+	std::vector<std::string> files;
+	std::vector<std::string> subdirs;
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA((dir + "\\*").c_str(), &data);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	do
+	{
+		std::string name = data.cFileName;
+		if (name.empty() || name[0] == '.')
+			continue;
+		std::string path = relpath.empty() ? name : relpath + "/" + name;
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			subdirs.push_back(path);
+		else
+			files.push_back(path);
+	} while (FindNextFileA(handle, &data));
+	FindClose(handle);
+#else
+	DIR *handle = opendir(dir.c_str());
+	if (!handle)
+		return false;
+
+	while (dirent *entry = readdir(handle))
+	{
+		std::string name = entry->d_name;
+		if (name.empty() || name[0] == '.')
+			continue;
+
+		std::string path = relpath.empty() ? name : relpath + "/" + name;
+		struct stat st;
+		if (stat((dir + "/" + name).c_str(), &st) != 0)
+			continue;
+		if (S_ISDIR(st.st_mode))
+			subdirs.push_back(path);
+		else
+			files.push_back(path);
+	}
+	closedir(handle);
+#endif
+
+	std::sort(files.begin(), files.end());
+	std::sort(subdirs.begin(), subdirs.end());
+	shaders.insert(shaders.end(), files.begin(), files.end());
+	for (auto &subdir : subdirs)
+		if (!walk_shader_directory(root, subdir, shaders))
+			return false;
+	return true;
+}
+
+// Mirrors reference_path() in test_shaders.py.
+static std::string reference_directory(std::string folder, bool opt)
+{
+	while (folder.size() > 1 && (folder.back() == '/' || folder.back() == '\\'))
+		folder.pop_back();
+
+	auto split = folder.find_last_of("/\\");
+	std::string parent = split == std::string::npos ? "." : folder.substr(0, split);
+	std::string name = split == std::string::npos ? folder : folder.substr(split + 1);
+	return parent + (opt ? "/reference/opt/" : "/reference/") + name;
+}
+
+static std::string describe_mismatch(const std::string &expected, const std::string &actual)
+{
+	size_t line = 1;
+	size_t offset = 0;
+	size_t len = std::min(expected.size(), actual.size());
+	while (offset < len && expected[offset] == actual[offset])
+	{
+		if (expected[offset] == '\n')
+			line++;
+		offset++;
+	}
+
+	auto line_at = [](const std::string &text, size_t pos) {
+		size_t begin = text.rfind('\n', pos == 0 ? 0 : pos - 1);
+		begin = begin == std::string::npos || pos == 0 ? 0 : begin + 1;
+		size_t end = text.find('\n', pos);
+		return text.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+	};
+
+	return "first difference at line " + std::to_string(line) + ":\n\texpected: " + line_at(expected, offset) +
+	       "\n\tactual:   " + line_at(actual, offset);
+}
+
+// Returns an empty string if every output matches its reference.
+static std::string run_shader(RegressionBackend backend, const std::string &shader, const std::string &spirv_folder,
+                              const std::string &reference_folder)
+{
+	auto spirv = read_spirv(spirv_folder + "/" + shader + ".spv");
+	if (spirv.empty())
+		return "no SPIR-V found, run test_shaders.py --emit-spirv first.";
+
+	std::vector<RegressionOutput> outputs;
+	try
+	{
+		outputs = backend(shader, spirv);
+	}
+	catch (const std::exception &e)
+	{
+		return std::string("SPIRV-Cross threw an exception: ") + e.what();
+	}
+
+	std::string errors;
+	for (auto &output : outputs)
+	{
+		if (!output.check_reference)
+			continue;
+
+		std::string reference_path = reference_folder + "/" + shader + output.suffix;
+		std::string reference;
+		if (!read_file(reference_path, reference))
+		{
+			errors += "missing reference " + reference_path + "\n";
+			continue;
+		}
+
+		reference = strip_carriage_returns(std::move(reference));
+		auto actual = strip_carriage_returns(std::move(output.source));
+		if (reference != actual)
+			errors += "does not match reference " + reference_path + ", " + describe_mismatch(reference, actual) + "\n";
+	}
+
+	return errors;
+}
+
+static void print_help()
+{
+	fprintf(stderr, "Usage: spirv-cross-regression-runner [--glsl | --hlsl | --msl] [--opt] [--jobs <count>]\n"
+	                "\t<shader folder> <SPIR-V folder>\n");
+}
+
+int main(int argc, char **argv)
+{
+	RegressionBackend backend = compile_regression_glsl;
+	bool opt = false;
+	uint32_t jobs = std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<std::string> folders;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--glsl") == 0)
+			backend = compile_regression_glsl;
+		else if (strcmp(argv[i], "--hlsl") == 0)
+			backend = compile_regression_hlsl;
+		else if (strcmp(argv[i], "--msl") == 0)
+			backend = compile_regression_msl;
+		else if (strcmp(argv[i], "--opt") == 0)
+			opt = true;
+		else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+			jobs = std::max(uint32_t(strtoul(argv[++i], nullptr, 0)), 1u);
+		else if (argv[i][0] != '-')
+			folders.push_back(argv[i]);
+		else
+		{
+			print_help();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (folders.size() != 2)
+	{
+		print_help();
+		return EXIT_FAILURE;
+	}
+
+	auto &shader_folder = folders[0];
+	auto &spirv_folder = folders[1];
+	auto reference_folder = reference_directory(shader_folder, opt);
+
+	std::vector<std::string> shaders;
+	if (!walk_shader_directory(shader_folder, "", shaders))
+	{
+		fprintf(stderr, "Failed to read shader folder: %s\n", shader_folder.c_str());
+		return EXIT_FAILURE;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::string> errors(shaders.size());
+	std::atomic<size_t> next_shader(0);
+	auto worker = [&]() {
+		size_t index;
+		while ((index = next_shader++) < shaders.size())
+			errors[index] = run_shader(backend, shaders[index], spirv_folder, reference_folder);
+	};
+
+	uint32_t thread_count = std::min(jobs, uint32_t(shaders.size()));
+	std::vector<std::thread> threads;
+	for (uint32_t i = 1; i < thread_count; i++)
+		threads.emplace_back(worker);
+	worker();
+	for (auto &t : threads)
+		t.join();
+
+	auto end = std::chrono::steady_clock::now();
+
+	size_t failure_count = 0;
+	for (size_t i = 0; i < shaders.size(); i++)
+	{
+		if (!errors[i].empty())
+		{
+			fprintf(stderr, "%s: %s", shaders[i].c_str(), errors[i].c_str());
+			if (errors[i].back() != '\n')
+				fprintf(stderr, "\n");
+			failure_count++;
+		}
+	}
+
+	printf("%u of %u shaders passed in %.1f ms.\n", unsigned(shaders.size() - failure_count), unsigned(shaders.size()),
+	       std::chrono::duration<double, std::milli>(end - start).count());
+	return failure_count ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+// Shared declarations for the in-process regression runner.
+// The GLSL and HLSL headers cannot be included in the same translation unit,
+// so every backend lives in its own source file.
+
+#ifndef SPIRV_CROSS_REGRESSION_RUNNER_HPP
+#define SPIRV_CROSS_REGRESSION_RUNNER_HPP
+
+#include "spirv_cross.hpp"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct RegressionOutput
+{
+	// Appended to the reference path of the shader, e.g. ".vk" for Vulkan GLSL.
+	std::string suffix;
+	std::string source;
+
+	// Some outputs are only compiled to make sure SPIRV-Cross accepts the shader, like test_shaders.py does.
+	bool check_reference;
+};
+
+using RegressionBackend = std::vector<RegressionOutput> (*)(const std::string &shader,
+                                                            const std::vector<uint32_t> &spirv);
+
+// Compile the SPIR-V for shader with every configuration test_shaders.py derives from the file name.
+std::vector<RegressionOutput> compile_regression_glsl(const std::string &shader, const std::vector<uint32_t> &spirv);
+std::vector<RegressionOutput> compile_regression_hlsl(const std::string &shader, const std::vector<uint32_t> &spirv);
+std::vector<RegressionOutput> compile_regression_msl(const std::string &shader, const std::vector<uint32_t> &spirv);
+
+// File name conventions are dot-separated tags, e.g. "foo.vk.frag" has the ".vk." tag.
+static inline bool shader_has_tag(const std::string &shader, const char *tag)
+{
+	return shader.find(tag) != std::string::npos;
+}
+
+// Equivalent of "--entry main" in the CLI, which requires the name to pick a unique entry point.
+static inline void set_regression_entry_point(spirv_cross::Compiler &compiler, const std::string &name)
+{
+	uint32_t stage_count = 0;
+	spv::ExecutionModel model = spv::ExecutionModelMax;
+	for (auto &e : compiler.get_entry_points_and_stages())
+	{
+		if (e.name == name)
+		{
+			stage_count++;
+			model = e.execution_model;
+		}
+	}
+
+	if (stage_count == 0)
+		throw std::runtime_error("There is no entry point with name: " + name);
+	else if (stage_count > 1)
+		throw std::runtime_error("There is more than one entry point with name: " + name);
+
+	compiler.set_entry_point(name, model);
+}
+
+// Common options which test_shaders.py passes to every backend.
+template <typename Options>
+static inline void set_regression_common_options(Options &opts, const std::string &shader)
+{
+	if (opts.version == 0)
+		throw std::runtime_error("SPIR-V did not specify language and no version was given.");
+
+	opts.emit_line_directives = shader_has_tag(shader, ".line.");
+	opts.force_zero_initialized_variables = shader_has_tag(shader, ".zero-initialize.");
+	opts.relax_nan_checks = shader_has_tag(shader, ".relax-nan.");
+	opts.materialize_reused_expressions = shader_has_tag(shader, ".materialize-reuse.");
+	opts.hoist_loop_invariant_loads = shader_has_tag(shader, ".hoist-loads.");
+	opts.lower_constant_switches = shader_has_tag(shader, ".lower-switch.");
+}
+
+#endif
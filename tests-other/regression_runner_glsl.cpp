@@ -0,0 +1,106 @@
+// GLSL configurations of the in-process regression runner, mirrors cross_compile() in test_shaders.py.
+
+#include "regression_runner.hpp"
+#include "spirv_glsl.hpp"
+#include "spirv_parser.hpp"
+
+using namespace spirv_cross;
+using namespace spv;
+
+static std::string compile_glsl(const std::string &shader, const std::vector<uint32_t> &spirv, bool vulkan_semantics)
+{
+	Parser parser(spirv);
+	parser.parse();
+	CompilerGLSL compiler(std::move(parser.get_parsed_ir()));
+
+	set_regression_entry_point(compiler, "main");
+
+	bool no_samplerless = shader_has_tag(shader, ".no-samplerless.");
+	bool combined_image_samplers = !vulkan_semantics;
+	bool build_dummy_sampler = !vulkan_semantics || no_samplerless;
+
+	auto opts = compiler.get_common_options();
+	if (shader_has_tag(shader, ".legacy."))
+	{
+		opts.version = 100;
+		opts.es = true;
+	}
+	if (shader_has_tag(shader, ".es."))
+	{
+		opts.version = 310;
+		opts.es = true;
+	}
+	set_regression_common_options(opts, shader);
+	opts.vulkan_semantics = vulkan_semantics;
+	opts.separate_shader_objects = shader_has_tag(shader, ".sso.");
+	opts.flatten_multidimensional_arrays = shader_has_tag(shader, ".flatten_dim.");
+	opts.emit_push_constant_as_uniform_buffer = shader_has_tag(shader, ".push-ubo.");
+	opts.enable_storage_image_qualifier_deduction = !shader_has_tag(shader, ".no-qualifier-deduction.");
+	opts.force_flattened_io_blocks = shader_has_tag(shader, ".force-flattened-io.");
+	opts.infer_relaxed_precision = shader_has_tag(shader, ".infer-precision.");
+	compiler.set_common_options(opts);
+
+	if (shader_has_tag(shader, ".framebuffer-fetch."))
+	{
+		bool coherent = !shader_has_tag(shader, ".framebuffer-fetch-noncoherent.");
+		for (uint32_t i = 0; i < 4; i++)
+			compiler.remap_ext_framebuffer_fetch(i, i, coherent);
+	}
+
+	if (build_dummy_sampler)
+	{
+		uint32_t sampler = compiler.build_dummy_sampler_for_combined_images();
+		if (sampler != 0)
+		{
+			compiler.set_decoration(sampler, DecorationDescriptorSet, 0);
+			compiler.set_decoration(sampler, DecorationBinding, 0);
+		}
+	}
+
+	ShaderResources res;
+	if (!shader_has_tag(shader, ".noeliminate."))
+	{
+		auto active = compiler.get_active_interface_variables();
+		res = compiler.get_shader_resources(active);
+		compiler.set_enabled_interface_variables(std::move(active));
+	}
+	else
+		res = compiler.get_shader_resources();
+
+	if (shader_has_tag(shader, ".flatten."))
+	{
+		for (auto &ubo : res.uniform_buffers)
+			compiler.flatten_buffer_block(ubo.id);
+		for (auto &ubo : res.push_constant_buffers)
+			compiler.flatten_buffer_block(ubo.id);
+	}
+
+	if (combined_image_samplers)
+	{
+		compiler.build_combined_image_samplers();
+		for (auto &remap : compiler.get_combined_image_samplers())
+		{
+			compiler.set_name(remap.combined_id, join("SPIRV_Cross_Combined", compiler.get_name(remap.image_id),
+			                                          compiler.get_name(remap.sampler_id)));
+		}
+	}
+
+	return compiler.compile();
+}
+
+std::vector<RegressionOutput> compile_regression_glsl(const std::string &shader, const std::vector<uint32_t> &spirv)
+{
+	std::vector<RegressionOutput> outputs;
+	bool vulkan = shader_has_tag(shader, ".vk.");
+	bool is_spirv = shader_has_tag(shader, ".asm.");
+
+	// A shader might not be possible to make valid GLSL from.
+	if (!shader_has_tag(shader, "nocompat") || !vulkan)
+		outputs.push_back({ "", compile_glsl(shader, spirv, false), true });
+
+	// SPIR-V shaders might just want to validate Vulkan GLSL output, we don't always care about the output.
+	if ((vulkan || is_spirv) && !shader_has_tag(shader, ".legacy."))
+		outputs.push_back({ ".vk", compile_glsl(shader, spirv, true), vulkan });
+
+	return outputs;
+}
@@ -0,0 +1,87 @@
+// HLSL configuration of the in-process regression runner, mirrors cross_compile_hlsl() in test_shaders.py.
+
+#include "regression_runner.hpp"
+#include "spirv_hlsl.hpp"
+#include "spirv_parser.hpp"
+
+using namespace spirv_cross;
+using namespace spv;
+
+static uint32_t shader_model(const std::string &shader)
+{
+	if (shader_has_tag(shader, ".sm62."))
+		return 62;
+	else if (shader_has_tag(shader, ".sm60."))
+		return 60;
+	else if (shader_has_tag(shader, ".sm51."))
+		return 51;
+	else if (shader_has_tag(shader, ".sm30."))
+		return 30;
+	else
+		return 50;
+}
+
+std::vector<RegressionOutput> compile_regression_hlsl(const std::string &shader, const std::vector<uint32_t> &spirv)
+{
+	Parser parser(spirv);
+	parser.parse();
+	CompilerHLSL compiler(std::move(parser.get_parsed_ir()));
+
+	set_regression_entry_point(compiler, "main");
+
+	auto opts = compiler.get_common_options();
+	set_regression_common_options(opts, shader);
+	opts.vertex.flip_vert_y = shader_has_tag(shader, ".flip-vert-y.");
+	compiler.set_common_options(opts);
+
+	auto hlsl_opts = compiler.get_hlsl_options();
+	hlsl_opts.shader_model = shader_model(shader);
+	hlsl_opts.point_size_compat = true;
+	hlsl_opts.point_coord_compat = true;
+	hlsl_opts.force_storage_buffer_as_uav = shader_has_tag(shader, ".force-uav.");
+	hlsl_opts.nonwritable_uav_texture_as_srv = shader_has_tag(shader, ".nonwritable-uav-texture.");
+	hlsl_opts.enable_16bit_types = shader_has_tag(shader, ".native-16bit.");
+	hlsl_opts.flatten_matrix_vertex_input_semantics = shader_has_tag(shader, ".flatten-matrix-vertex-input.");
+	hlsl_opts.preserve_structured_buffers = shader_has_tag(shader, ".structured.");
+	hlsl_opts.coalesce_byte_address_buffer_access = shader_has_tag(shader, ".coalesce.");
+	hlsl_opts.infer_structured_buffers = shader_has_tag(shader, ".infer-structured.");
+	hlsl_opts.infer_typed_buffers = shader_has_tag(shader, ".infer-typed.");
+	hlsl_opts.elide_stage_io_copies = shader_has_tag(shader, ".elide-io.");
+	hlsl_opts.cache_texture_queries = shader_has_tag(shader, ".cache-queries.");
+	compiler.set_hlsl_options(hlsl_opts);
+
+	// Shader model 3.0 has no separate textures and samplers.
+	bool legacy = hlsl_opts.shader_model <= 30;
+	if (legacy)
+	{
+		uint32_t sampler = compiler.build_dummy_sampler_for_combined_images();
+		if (sampler != 0)
+		{
+			compiler.set_decoration(sampler, DecorationDescriptorSet, 0);
+			compiler.set_decoration(sampler, DecorationBinding, 0);
+		}
+	}
+
+	if (shader_has_tag(shader, ".flatten."))
+	{
+		auto res = compiler.get_shader_resources();
+		for (auto &ubo : res.uniform_buffers)
+			compiler.flatten_buffer_block(ubo.id);
+		for (auto &ubo : res.push_constant_buffers)
+			compiler.flatten_buffer_block(ubo.id);
+	}
+
+	if (legacy)
+	{
+		compiler.build_combined_image_samplers();
+		for (auto &remap : compiler.get_combined_image_samplers())
+		{
+			compiler.set_name(remap.combined_id, join("SPIRV_Cross_Combined", compiler.get_name(remap.image_id),
+			                                          compiler.get_name(remap.sampler_id)));
+		}
+	}
+
+	compiler.remap_num_workgroups_builtin();
+
+	return { { "", compiler.compile(), true } };
+}
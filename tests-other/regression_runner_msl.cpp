@@ -0,0 +1,145 @@
+// MSL configuration of the in-process regression runner, mirrors cross_compile_msl() in test_shaders.py.
+
+#include "regression_runner.hpp"
+#include "spirv_msl.hpp"
+#include "spirv_parser.hpp"
+
+using namespace spirv_cross;
+using namespace spv;
+
+static uint32_t msl_version(const std::string &shader)
+{
+	if (shader_has_tag(shader, ".msl3."))
+		return CompilerMSL::Options::make_msl_version(3);
+	else if (shader_has_tag(shader, ".msl2."))
+		return CompilerMSL::Options::make_msl_version(2);
+	else if (shader_has_tag(shader, ".msl21."))
+		return CompilerMSL::Options::make_msl_version(2, 1);
+	else if (shader_has_tag(shader, ".msl22."))
+		return CompilerMSL::Options::make_msl_version(2, 2);
+	else if (shader_has_tag(shader, ".msl23."))
+		return CompilerMSL::Options::make_msl_version(2, 3);
+	else if (shader_has_tag(shader, ".msl24."))
+		return CompilerMSL::Options::make_msl_version(2, 4);
+	else if (shader_has_tag(shader, ".msl11."))
+		return CompilerMSL::Options::make_msl_version(1, 1);
+	else
+		return CompilerMSL::Options::make_msl_version(1, 2);
+}
+
+static void add_shader_input(CompilerMSL &compiler, uint32_t location, MSLShaderVariableFormat format, uint32_t vecsize)
+{
+	MSLShaderInterfaceVariable input;
+	input.location = location;
+	input.format = format;
+	input.vecsize = vecsize;
+	compiler.add_msl_shader_input(input);
+}
+
+std::vector<RegressionOutput> compile_regression_msl(const std::string &shader, const std::vector<uint32_t> &spirv)
+{
+	Parser parser(spirv);
+	parser.parse();
+	CompilerMSL compiler(std::move(parser.get_parsed_ir()));
+
+	// The arbitrary values below match the ones test_shaders.py passes to the CLI.
+	auto msl_opts = compiler.get_msl_options();
+	msl_opts.msl_version = msl_version(shader);
+	msl_opts.capture_output_to_buffer = shader_has_tag(shader, ".capture.");
+	msl_opts.swizzle_texture_samples = shader_has_tag(shader, ".swizzle.");
+	msl_opts.invariant_float_math = shader_has_tag(shader, ".invariant-float-math.");
+	if (shader_has_tag(shader, ".ios."))
+	{
+		msl_opts.platform = CompilerMSL::Options::iOS;
+		msl_opts.emulate_cube_array = shader_has_tag(shader, ".emulate-cube-array.");
+	}
+	msl_opts.use_framebuffer_fetch_subpasses = shader_has_tag(shader, ".framebuffer-fetch.");
+	msl_opts.pad_fragment_output_components = shader_has_tag(shader, ".pad-fragment.");
+	msl_opts.tess_domain_origin_lower_left = shader_has_tag(shader, ".domain.");
+	msl_opts.argument_buffers = shader_has_tag(shader, ".argument.");
+	// test_shaders.py passes "--msl-argument-buffer-tier 1", which is the zero-based tier index.
+	if (shader_has_tag(shader, ".argument-tier-1."))
+		msl_opts.argument_buffers_tier = CompilerMSL::Options::ArgumentBuffersTier::Tier2;
+	msl_opts.texture_buffer_native = shader_has_tag(shader, ".texture-buffer-native.");
+	msl_opts.multiview = shader_has_tag(shader, ".multiview.");
+	msl_opts.multiview_layered_rendering = !shader_has_tag(shader, ".no-layered.");
+	msl_opts.view_index_from_device_index = shader_has_tag(shader, ".viewfromdev.");
+	msl_opts.dispatch_base = shader_has_tag(shader, ".dispatchbase.");
+	msl_opts.enable_decoration_binding = shader_has_tag(shader, ".decoration-binding.");
+	msl_opts.force_active_argument_buffer_resources = shader_has_tag(shader, ".force-active.");
+	msl_opts.force_native_arrays = shader_has_tag(shader, ".force-native-array.");
+	if (shader_has_tag(shader, ".frag-output."))
+	{
+		msl_opts.enable_frag_depth_builtin = false;
+		msl_opts.enable_frag_stencil_ref_builtin = false;
+		msl_opts.enable_frag_output_mask = 0x000000ca;
+	}
+	msl_opts.enable_clip_distance_user_varying = !shader_has_tag(shader, ".no-user-varying.");
+	msl_opts.raw_buffer_tese_input = shader_has_tag(shader, ".raw-tess-in.");
+	msl_opts.multi_patch_workgroup = shader_has_tag(shader, ".multi-patch.");
+	msl_opts.vertex_for_tessellation = shader_has_tag(shader, ".for-tess.");
+	if (shader_has_tag(shader, ".fixed-sample-mask."))
+		msl_opts.additional_fixed_sample_mask = 0x00000022;
+	msl_opts.arrayed_subpass_input = shader_has_tag(shader, ".arrayed-subpass.");
+	msl_opts.texture_1D_as_2D = shader_has_tag(shader, ".1d-as-2d.");
+	msl_opts.ios_use_simdgroup_functions = shader_has_tag(shader, ".simd.");
+	msl_opts.emulate_subgroups = shader_has_tag(shader, ".emulate-subgroup.");
+	if (shader_has_tag(shader, ".fixed-subgroup."))
+		msl_opts.fixed_subgroup_size = 32;
+	msl_opts.force_sample_rate_shading = shader_has_tag(shader, ".force-sample.");
+	msl_opts.check_discarded_frag_stores = shader_has_tag(shader, ".discard-checks.");
+	msl_opts.sample_dref_lod_array_as_grad = shader_has_tag(shader, ".lod-as-grad.");
+	msl_opts.ios_support_base_vertex_instance = true;
+	msl_opts.runtime_array_rich_descriptor = shader_has_tag(shader, ".rich-descriptor.");
+	msl_opts.minimize_packed_struct_members = shader_has_tag(shader, ".minimize-packing.");
+	compiler.set_msl_options(msl_opts);
+
+	if (shader_has_tag(shader, ".discrete."))
+	{
+		compiler.add_discrete_descriptor_set(2);
+		compiler.add_discrete_descriptor_set(3);
+	}
+	if (shader_has_tag(shader, ".device-argument-buffer."))
+	{
+		compiler.set_argument_buffer_device_address_space(0, true);
+		compiler.set_argument_buffer_device_address_space(1, true);
+	}
+	if (shader_has_tag(shader, ".dynamic-buffer."))
+	{
+		compiler.add_dynamic_buffer(0, 0, 0);
+		compiler.add_dynamic_buffer(1, 2, 1);
+	}
+	if (shader_has_tag(shader, ".inline-block."))
+		compiler.add_inline_uniform_block(0, 0);
+	if (shader_has_tag(shader, ".shader-inputs."))
+	{
+		add_shader_input(compiler, 0, MSL_SHADER_VARIABLE_FORMAT_UINT8, 2);
+		add_shader_input(compiler, 1, MSL_SHADER_VARIABLE_FORMAT_UINT16, 3);
+		add_shader_input(compiler, 6, MSL_SHADER_VARIABLE_FORMAT_OTHER, 4);
+	}
+	if (shader_has_tag(shader, ".multi-patch."))
+	{
+		add_shader_input(compiler, 0, MSL_SHADER_VARIABLE_FORMAT_ANY32, 3);
+		add_shader_input(compiler, 1, MSL_SHADER_VARIABLE_FORMAT_ANY16, 2);
+	}
+
+	if (shader_has_tag(shader, ".mask-location-0."))
+		compiler.mask_stage_output_by_location(0, 0);
+	if (shader_has_tag(shader, ".mask-location-1."))
+		compiler.mask_stage_output_by_location(1, 0);
+	if (shader_has_tag(shader, ".mask-position."))
+		compiler.mask_stage_output_by_builtin(BuiltInPosition);
+	if (shader_has_tag(shader, ".mask-point-size."))
+		compiler.mask_stage_output_by_builtin(BuiltInPointSize);
+	if (shader_has_tag(shader, ".mask-clip-distance."))
+		compiler.mask_stage_output_by_builtin(BuiltInClipDistance);
+
+	if (!shader_has_tag(shader, ".nomain."))
+		set_regression_entry_point(compiler, "main");
+
+	auto opts = compiler.get_common_options();
+	set_regression_common_options(opts, shader);
+	compiler.set_common_options(opts);
+
+	return { { "", compiler.compile(), true } };
+}
@@ -0,0 +1,583 @@
+// Generates synthetic SPIR-V modules which grow along one dimension at a time
+// (basic blocks, call depth, constant array size, resource count, expression depth),
+// and measures how parse and compile time and peak memory scale with the size.
+// This catches super-linear behavior which the small hand-written test shaders never hit.
+//
+// Usage:
+//   spirv-cross-scaling-benchmark [--msl] [--quick] [dimension...]
+//   spirv-cross-scaling-benchmark --emit <dimension> <size> <output.spv>
+
+#include "spirv_glsl.hpp"
+#include "spirv_msl.hpp"
+#include "spirv_parser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+using namespace spirv_cross;
+using namespace spv;
+
+// Minimal SPIR-V module builder. Instructions are appended to the logical layout section they belong to.
+class ModuleBuilder
+{
+public:
+	uint32_t id()
+	{
+		return next_id++;
+	}
+
+	void op(std::vector<uint32_t> &section, Op opcode, const std::vector<uint32_t> &operands)
+	{
+		section.push_back((uint32_t(operands.size() + 1) << 16) | uint32_t(opcode));
+		section.insert(section.end(), operands.begin(), operands.end());
+	}
+
+	static std::vector<uint32_t> string_operand(const std::string &str)
+	{
+		std::vector<uint32_t> words((str.size() + 4) / 4);
+		memcpy(words.data(), str.c_str(), str.size());
+		return words;
+	}
+
+	void name(uint32_t target, const std::string &str)
+	{
+		auto operands = string_operand(str);
+		operands.insert(operands.begin(), target);
+		op(names, OpName, operands);
+	}
+
+	void decorate(uint32_t target, Decoration decoration, const std::vector<uint32_t> &literals = {})
+	{
+		std::vector<uint32_t> operands = { target, uint32_t(decoration) };
+		operands.insert(operands.end(), literals.begin(), literals.end());
+		op(annotations, OpDecorate, operands);
+	}
+
+	uint32_t constant_float(uint32_t type, float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		uint32_t result = id();
+		op(globals, OpConstant, { type, result, bits });
+		return result;
+	}
+
+	uint32_t constant_int(uint32_t type, uint32_t value)
+	{
+		uint32_t result = id();
+		op(globals, OpConstant, { type, result, value });
+		return result;
+	}
+
+	std::vector<uint32_t> finish() const
+	{
+		std::vector<uint32_t> words = { MagicNumber, 0x10000, 0, next_id, 0 };
+		for (auto *section : { &header, &names, &annotations, &globals, &functions })
+			words.insert(words.end(), section->begin(), section->end());
+		return words;
+	}
+
+	std::vector<uint32_t> header, names, annotations, globals, functions;
+
+private:
+	uint32_t next_id = 1;
+};
+
+// The common skeleton: a fragment shader which reads gl_FragCoord and writes one vec4 output.
+struct FragmentModule
+{
+	FragmentModule()
+	{
+		b.op(b.header, OpCapability, { CapabilityShader });
+		b.op(b.header, OpMemoryModel, { AddressingModelLogical, MemoryModelGLSL450 });
+
+		void_type = b.id();
+		void_func_type = b.id();
+		float_type = b.id();
+		vec4_type = b.id();
+		int_type = b.id();
+		bool_type = b.id();
+		b.op(b.globals, OpTypeVoid, { void_type });
+		b.op(b.globals, OpTypeFunction, { void_func_type, void_type });
+		b.op(b.globals, OpTypeFloat, { float_type, 32 });
+		b.op(b.globals, OpTypeVector, { vec4_type, float_type, 4 });
+		b.op(b.globals, OpTypeInt, { int_type, 32, 1 });
+		b.op(b.globals, OpTypeBool, { bool_type });
+
+		uint32_t input_ptr = b.id();
+		uint32_t output_ptr = b.id();
+		b.op(b.globals, OpTypePointer, { input_ptr, StorageClassInput, vec4_type });
+		b.op(b.globals, OpTypePointer, { output_ptr, StorageClassOutput, vec4_type });
+		frag_coord = b.id();
+		frag_color = b.id();
+		b.op(b.globals, OpVariable, { input_ptr, frag_coord, StorageClassInput });
+		b.op(b.globals, OpVariable, { output_ptr, frag_color, StorageClassOutput });
+		b.decorate(frag_coord, DecorationBuiltIn, { BuiltInFragCoord });
+		b.decorate(frag_color, DecorationLocation, { 0 });
+		b.name(frag_color, "FragColor");
+
+		main_func = b.id();
+		auto entry = ModuleBuilder::string_operand("main");
+		entry.insert(entry.begin(), { ExecutionModelFragment, main_func });
+		entry.insert(entry.end(), { frag_coord, frag_color });
+		b.op(b.header, OpEntryPoint, entry);
+		b.op(b.header, OpExecutionMode, { main_func, ExecutionModeOriginUpperLeft });
+		b.op(b.header, OpSource, { SourceLanguageGLSL, 450 });
+		b.name(main_func, "main");
+	}
+
+	// Opens main() and returns gl_FragCoord.x as a non-constant value to build on.
+	uint32_t begin_main(const std::vector<uint32_t> &function_variables = {})
+	{
+		b.op(b.functions, OpFunction, { void_type, main_func, FunctionControlMaskNone, void_func_type });
+		b.op(b.functions, OpLabel, { b.id() });
+		for (size_t i = 0; i + 1 < function_variables.size(); i += 2)
+			b.op(b.functions, OpVariable, { function_variables[i], function_variables[i + 1], StorageClassFunction });
+
+		uint32_t coord = b.id();
+		uint32_t x = b.id();
+		b.op(b.functions, OpLoad, { vec4_type, coord, frag_coord });
+		b.op(b.functions, OpCompositeExtract, { float_type, x, coord, 0 });
+		return x;
+	}
+
+	void end_main(uint32_t value)
+	{
+		uint32_t color = b.id();
+		b.op(b.functions, OpCompositeConstruct, { vec4_type, color, value, value, value, value });
+		b.op(b.functions, OpStore, { frag_color, color });
+		b.op(b.functions, OpReturn, {});
+		b.op(b.functions, OpFunctionEnd, {});
+	}
+
+	ModuleBuilder b;
+	uint32_t void_type, void_func_type, float_type, vec4_type, int_type, bool_type;
+	uint32_t frag_coord, frag_color, main_func;
+};
+
+// A chain of N selections which conditionally update one function variable, 2N + 1 blocks.
+// Merge chains are emitted recursively, so the stack depth grows with N as well, see run_with_large_stack().
+static std::vector<uint32_t> generate_blocks(uint32_t count)
+{
+	FragmentModule m;
+	auto &b = m.b;
+	uint32_t ptr_type = b.id();
+	b.op(b.globals, OpTypePointer, { ptr_type, StorageClassFunction, m.float_type });
+	uint32_t one = b.constant_float(m.float_type, 1.0f);
+	uint32_t var = b.id();
+	b.name(var, "acc");
+
+	uint32_t x = m.begin_main({ ptr_type, var });
+	b.op(b.functions, OpStore, { var, x });
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t value = b.id(), cond = b.id(), then_label = b.id(), merge_label = b.id();
+		b.op(b.functions, OpLoad, { m.float_type, value, var });
+		b.op(b.functions, OpFOrdLessThan, { m.bool_type, cond, value, x });
+		b.op(b.functions, OpSelectionMerge, { merge_label, SelectionControlMaskNone });
+		b.op(b.functions, OpBranchConditional, { cond, then_label, merge_label });
+
+		uint32_t loaded = b.id(), sum = b.id();
+		b.op(b.functions, OpLabel, { then_label });
+		b.op(b.functions, OpLoad, { m.float_type, loaded, var });
+		b.op(b.functions, OpFAdd, { m.float_type, sum, loaded, one });
+		b.op(b.functions, OpStore, { var, sum });
+		b.op(b.functions, OpBranch, { merge_label });
+		b.op(b.functions, OpLabel, { merge_label });
+	}
+
+	uint32_t result = b.id();
+	b.op(b.functions, OpLoad, { m.float_type, result, var });
+	m.end_main(result);
+	return b.finish();
+}
+
+// N functions where each one calls the previous one, so the call graph is N deep.
+static std::vector<uint32_t> generate_functions(uint32_t count)
+{
+	FragmentModule m;
+	auto &b = m.b;
+	uint32_t func_type = b.id();
+	b.op(b.globals, OpTypeFunction, { func_type, m.float_type, m.float_type });
+	uint32_t one = b.constant_float(m.float_type, 1.0f);
+
+	uint32_t previous = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t func = b.id(), param = b.id(), result = b.id();
+		b.name(func, "func" + std::to_string(i));
+		b.op(b.functions, OpFunction, { m.float_type, func, FunctionControlMaskNone, func_type });
+		b.op(b.functions, OpFunctionParameter, { m.float_type, param });
+		b.op(b.functions, OpLabel, { b.id() });
+		uint32_t value = param;
+		if (previous)
+		{
+			value = b.id();
+			b.op(b.functions, OpFunctionCall, { m.float_type, value, previous, param });
+		}
+		b.op(b.functions, OpFAdd, { m.float_type, result, value, one });
+		b.op(b.functions, OpReturnValue, { result });
+		b.op(b.functions, OpFunctionEnd, {});
+		previous = func;
+	}
+
+	uint32_t x = m.begin_main();
+	uint32_t result = b.id();
+	b.op(b.functions, OpFunctionCall, { m.float_type, result, previous, x });
+	m.end_main(result);
+	return b.finish();
+}
+
+// One private float[N] array initialized from a constant composite, indexed dynamically.
+static std::vector<uint32_t> generate_constants(uint32_t count)
+{
+	FragmentModule m;
+	auto &b = m.b;
+	uint32_t length = b.constant_int(m.int_type, count);
+	uint32_t array_type = b.id();
+	b.op(b.globals, OpTypeArray, { array_type, m.float_type, length });
+
+	std::vector<uint32_t> operands = { array_type, b.id() };
+	for (uint32_t i = 0; i < count; i++)
+		operands.push_back(b.constant_float(m.float_type, float(i) * 0.5f));
+	uint32_t composite = operands[1];
+	b.op(b.globals, OpConstantComposite, operands);
+
+	uint32_t array_ptr = b.id(), float_ptr = b.id(), var = b.id();
+	b.op(b.globals, OpTypePointer, { array_ptr, StorageClassPrivate, array_type });
+	b.op(b.globals, OpTypePointer, { float_ptr, StorageClassPrivate, m.float_type });
+	b.op(b.globals, OpVariable, { array_ptr, var, StorageClassPrivate, composite });
+	b.name(var, "table");
+
+	uint32_t x = m.begin_main();
+	uint32_t index = b.id(), element = b.id(), result = b.id();
+	b.op(b.functions, OpConvertFToS, { m.int_type, index, x });
+	b.op(b.functions, OpAccessChain, { float_ptr, element, var, index });
+	b.op(b.functions, OpLoad, { m.float_type, result, element });
+	m.end_main(result);
+	return b.finish();
+}
+
+// N uniform buffers which are all read and summed up.
+static std::vector<uint32_t> generate_resources(uint32_t count)
+{
+	FragmentModule m;
+	auto &b = m.b;
+	uint32_t block_type = b.id(), block_ptr = b.id(), member_ptr = b.id();
+	b.op(b.globals, OpTypeStruct, { block_type, m.vec4_type });
+	b.op(b.globals, OpTypePointer, { block_ptr, StorageClassUniform, block_type });
+	b.op(b.globals, OpTypePointer, { member_ptr, StorageClassUniform, m.vec4_type });
+	b.decorate(block_type, DecorationBlock);
+	b.op(b.annotations, OpMemberDecorate, { block_type, 0, DecorationOffset, 0 });
+	b.name(block_type, "UBO");
+	uint32_t zero = b.constant_int(m.int_type, 0);
+
+	std::vector<uint32_t> buffers;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t var = b.id();
+		b.op(b.globals, OpVariable, { block_ptr, var, StorageClassUniform });
+		b.decorate(var, DecorationDescriptorSet, { 0 });
+		b.decorate(var, DecorationBinding, { i });
+		b.name(var, "ubo" + std::to_string(i));
+		buffers.push_back(var);
+	}
+
+	uint32_t sum = m.begin_main();
+	for (auto var : buffers)
+	{
+		uint32_t ptr = b.id(), value = b.id(), component = b.id(), next = b.id();
+		b.op(b.functions, OpAccessChain, { member_ptr, ptr, var, zero });
+		b.op(b.functions, OpLoad, { m.vec4_type, value, ptr });
+		b.op(b.functions, OpCompositeExtract, { m.float_type, component, value, 0 });
+		b.op(b.functions, OpFAdd, { m.float_type, next, sum, component });
+		sum = next;
+	}
+	m.end_main(sum);
+	return b.finish();
+}
+
+// N arithmetic operations where every result is used exactly once, so they forward into one N deep expression.
+static std::vector<uint32_t> generate_expressions(uint32_t count)
+{
+	FragmentModule m;
+	auto &b = m.b;
+	uint32_t two = b.constant_float(m.float_type, 2.0f);
+	uint32_t half = b.constant_float(m.float_type, 0.5f);
+
+	uint32_t value = m.begin_main();
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t next = b.id();
+		b.op(b.functions, (i & 1) ? OpFMul : OpFAdd, { m.float_type, next, value, (i & 1) ? half : two });
+		value = next;
+	}
+	m.end_main(value);
+	return b.finish();
+}
+
+struct Dimension
+{
+	const char *name;
+	std::vector<uint32_t> (*generate)(uint32_t count);
+	uint32_t base_size;
+};
+
+static const Dimension dimensions[] = {
+	{ "blocks", generate_blocks, 1250 },
+	{ "functions", generate_functions, 250 },
+	{ "constants", generate_constants, 4096 },
+	{ "resources", generate_resources, 128 },
+	{ "expressions", generate_expressions, 250 },
+};
+
+// Peak memory is measured by routing the library's container allocations through counting callbacks.
+// Unlike the process RSS, this is exact and does not depend on what the allocator returned to the OS.
+// Memory held by standard library containers, such as the output string, is not included.
+struct AllocationCounter
+{
+	size_t live_bytes = 0;
+	size_t peak_bytes = 0;
+};
+
+// Stores the size in front of the returned block so frees can be accounted for.
+union SizeHeader
+{
+	size_t size;
+	max_align_t align;
+};
+
+static void *counting_allocate(void *userdata, size_t size)
+{
+	auto *counter = static_cast<AllocationCounter *>(userdata);
+	auto *header = static_cast<SizeHeader *>(malloc(size + sizeof(SizeHeader)));
+	if (!header)
+		return nullptr;
+
+	header->size = size;
+	counter->live_bytes += size;
+	counter->peak_bytes = std::max(counter->peak_bytes, counter->live_bytes);
+	return header + 1;
+}
+
+static void counting_free(void *userdata, void *ptr)
+{
+	auto *counter = static_cast<AllocationCounter *>(userdata);
+	auto *header = static_cast<SizeHeader *>(ptr) - 1;
+	counter->live_bytes -= header->size;
+	free(header);
+}
+
+struct Measurement
+{
+	double parse_ms = 1e30;
+	double compile_ms = 1e30;
+	size_t peak_bytes = 0;
+	size_t output_size = 0;
+};
+
+template <typename T>
+static Measurement measure(const std::vector<uint32_t> &spirv, unsigned repetitions)
+{
+	using Clock = std::chrono::steady_clock;
+	Measurement result;
+
+	AllocationCounter counter;
+	AllocationCallbacks callbacks = { &counter, counting_allocate, counting_free };
+
+	for (unsigned rep = 0; rep < repetitions; rep++)
+	{
+		// Declared first so that the parser and compiler are freed while it is still installed.
+		AllocationScope scope(&callbacks);
+		counter.peak_bytes = counter.live_bytes;
+
+		auto start = Clock::now();
+		Parser parser(spirv);
+		parser.parse();
+		auto parsed = Clock::now();
+
+		// Analysis and emission are interleaved inside compile(), so they are timed together.
+		T compiler(std::move(parser.get_parsed_ir()));
+		auto output = compiler.compile();
+		auto end = Clock::now();
+
+		result.peak_bytes = std::max(result.peak_bytes, counter.peak_bytes);
+
+		result.parse_ms = std::min(result.parse_ms, std::chrono::duration<double, std::milli>(parsed - start).count());
+		result.compile_ms = std::min(result.compile_ms, std::chrono::duration<double, std::milli>(end - parsed).count());
+		result.output_size = output.size();
+	}
+
+	return result;
+}
+
+// Estimates k in time ~ size^k between two measurements. Small times are too noisy to say anything.
+static double scaling_exponent(double t0, double t1, double size_ratio)
+{
+	if (t0 < 0.5)
+		return -1.0;
+	return std::log(t1 / t0) / std::log(size_ratio);
+}
+
+static std::string exponent_to_string(double k)
+{
+	if (k < 0.0)
+		return "-";
+	char buf[32];
+	sprintf(buf, "%.2f", k);
+	return buf;
+}
+
+template <typename T>
+static bool benchmark_dimension(const Dimension &dim, bool quick)
+{
+	const unsigned steps = quick ? 2 : 4;
+	const uint32_t base = quick ? std::max(dim.base_size / 8, 1u) : dim.base_size;
+
+	printf("%s:\n", dim.name);
+	printf("  %8s %10s %10s %11s %10s %10s\n", "size", "words", "parse ms", "compile ms", "peak KiB", "output");
+
+	std::vector<Measurement> results;
+	for (unsigned step = 0; step < steps; step++)
+	{
+		uint32_t size = base << step;
+		auto spirv = dim.generate(size);
+
+		Measurement m;
+		try
+		{
+			m = measure<T>(spirv, size == base ? 3 : 2);
+		}
+		catch (const std::exception &e)
+		{
+			fprintf(stderr, "  %s at size %u failed: %s\n", dim.name, size, e.what());
+			return false;
+		}
+
+		printf("  %8u %10u %10.2f %11.2f %10u %10u\n", size, unsigned(spirv.size()), m.parse_ms, m.compile_ms,
+		       unsigned((m.peak_bytes + 1023) / 1024), unsigned(m.output_size));
+		results.push_back(m);
+	}
+
+	double size_ratio = double(1u << (steps - 1));
+	double parse_k = scaling_exponent(results.front().parse_ms, results.back().parse_ms, size_ratio);
+	double compile_k = scaling_exponent(results.front().compile_ms, results.back().compile_ms, size_ratio);
+	printf("  scaling exponent: parse %s, compile %s%s\n\n", exponent_to_string(parse_k).c_str(),
+	       exponent_to_string(compile_k).c_str(), std::max(parse_k, compile_k) > 1.5 ? " (super-linear)" : "");
+	return true;
+}
+
+static const Dimension *find_dimension(const char *name)
+{
+	for (auto &dim : dimensions)
+		if (strcmp(dim.name, name) == 0)
+			return &dim;
+	fprintf(stderr, "Unknown dimension: %s\n", name);
+	return nullptr;
+}
+
+static int emit_module(const char *name, const char *size, const char *path)
+{
+	auto *dim = find_dimension(name);
+	if (!dim)
+		return EXIT_FAILURE;
+
+	auto spirv = dim->generate(uint32_t(strtoul(size, nullptr, 0)));
+	FILE *file = fopen(path, "wb");
+	if (!file)
+	{
+		fprintf(stderr, "Failed to open %s for writing.\n", path);
+		return EXIT_FAILURE;
+	}
+
+	bool ok = fwrite(spirv.data(), sizeof(uint32_t), spirv.size(), file) == spirv.size();
+	fclose(file);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+struct BenchmarkRun
+{
+	std::vector<const Dimension *> selected;
+	bool msl = false;
+	bool quick = false;
+	bool ok = true;
+};
+
+static void *run_benchmarks(void *data)
+{
+	auto &run = *static_cast<BenchmarkRun *>(data);
+	for (auto *dim : run.selected)
+	{
+		run.ok = run.msl ? benchmark_dimension<CompilerMSL>(*dim, run.quick) :
+		                   benchmark_dimension<CompilerGLSL>(*dim, run.quick);
+		if (!run.ok)
+			break;
+	}
+	return nullptr;
+}
+
+// Structured control flow is emitted recursively along merge chains, so a few thousand selections in
+// sequence already exhaust a default 8 MiB stack. Measure on a thread with a larger stack instead.
+static void run_with_large_stack(BenchmarkRun &run)
+{
+#ifndef _WIN32
+	pthread_attr_t attr;
+	pthread_t thread;
+	if (pthread_attr_init(&attr) == 0)
+	{
+		bool started = pthread_attr_setstacksize(&attr, 512u * 1024u * 1024u) == 0 &&
+		               pthread_create(&thread, &attr, run_benchmarks, &run) == 0;
+		pthread_attr_destroy(&attr);
+		if (started)
+		{
+			pthread_join(thread, nullptr);
+			return;
+		}
+	}
+#endif
+	run_benchmarks(&run);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc == 5 && strcmp(argv[1], "--emit") == 0)
+		return emit_module(argv[2], argv[3], argv[4]);
+
+	// Keep partial results visible if a module still overflows the stack.
+	setvbuf(stdout, nullptr, _IOLBF, 0);
+
+	bool msl = false;
+	bool quick = false;
+	std::vector<const Dimension *> selected;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--msl") == 0)
+			msl = true;
+		else if (strcmp(argv[i], "--quick") == 0)
+			quick = true;
+		else if (auto *dim = find_dimension(argv[i]))
+			selected.push_back(dim);
+		else
+			return EXIT_FAILURE;
+	}
+
+	if (selected.empty())
+		for (auto &dim : dimensions)
+			selected.push_back(&dim);
+
+	BenchmarkRun run;
+	run.selected = std::move(selected);
+	run.msl = msl;
+	run.quick = quick;
+	run_with_large_stack(run);
+	return run.ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -207,6 +207,106 @@ static void convert_to_std_vector()
 #endif
 }
 
+static void trivial_growth()
+{
+	SmallVector<uint32_t, 2> ints;
+	for (uint32_t i = 0; i < 1000; i++)
+		ints.push_back(i);
+	SPVC_ASSERT(ints.size() == 1000);
+	for (uint32_t i = 0; i < 1000; i++)
+		SPVC_ASSERT(ints[i] == i);
+
+	SmallVector<uint32_t, 2> copy(ints);
+	SPVC_ASSERT(copy.size() == 1000);
+	SPVC_ASSERT(copy[999] == 999);
+
+	SmallVector<uint32_t, 2> moved(std::move(copy));
+	SPVC_ASSERT(moved.size() == 1000);
+	moved.push_back(1000);
+	SPVC_ASSERT(moved[0] == 0 && moved[1000] == 1000);
+}
+
+static void trivial_insert_middle()
+{
+	SmallVector<uint32_t, 2> ints;
+	ints.push_back(1);
+	ints.push_back(2);
+
+	const uint32_t new_ints[3] = { 10, 20, 30 };
+	ints.insert(ints.begin() + 1, new_ints, new_ints + 3);
+	SPVC_ASSERT(ints.size() == 5);
+	SPVC_ASSERT(ints[0] == 1);
+	SPVC_ASSERT(ints[1] == 10);
+	SPVC_ASSERT(ints[2] == 20);
+	SPVC_ASSERT(ints[3] == 30);
+	SPVC_ASSERT(ints[4] == 2);
+
+	ints.insert(ints.begin(), new_ints, new_ints + 3);
+	ints.insert(ints.end(), new_ints, new_ints + 1);
+	SPVC_ASSERT(ints.size() == 9);
+	SPVC_ASSERT(ints[0] == 10);
+	SPVC_ASSERT(ints[3] == 1);
+	SPVC_ASSERT(ints[7] == 2);
+	SPVC_ASSERT(ints[8] == 10);
+}
+
+static void trivial_resize_uninitialized()
+{
+	SmallVector<uint32_t, 4> ints;
+	ints.push_back(7);
+	ints.resize_uninitialized(100);
+	SPVC_ASSERT(ints.size() == 100);
+	SPVC_ASSERT(ints[0] == 7);
+	for (uint32_t i = 1; i < 100; i++)
+		ints[i] = i;
+	ints.resize_uninitialized(10);
+	SPVC_ASSERT(ints.size() == 10);
+	SPVC_ASSERT(ints[9] == 9);
+}
+
+static size_t callback_allocations = 0;
+static size_t callback_frees = 0;
+
+static void *counting_allocate(void *, size_t size)
+{
+	callback_allocations++;
+	return malloc(size);
+}
+
+static void counting_free(void *, void *ptr)
+{
+	callback_frees++;
+	free(ptr);
+}
+
+static void trivial_growth_with_callbacks()
+{
+	AllocationCallbacks callbacks = { nullptr, counting_allocate, counting_free };
+
+	{
+		SmallVector<uint32_t, 2> outside;
+		outside.resize(100);
+		outside[99] = 99;
+
+		{
+			AllocationScope scope(&callbacks);
+			// Growing memory from the default allocator must move it over to the active callbacks.
+			outside.resize(1000);
+			SPVC_ASSERT(outside[99] == 99);
+
+			SmallVector<uint32_t, 2> inside;
+			for (uint32_t i = 0; i < 1000; i++)
+				inside.push_back(i);
+			SPVC_ASSERT(inside[999] == 999);
+		}
+
+		SPVC_ASSERT(callback_allocations > 0);
+	}
+
+	// Memory is returned to the callbacks it came from, even outside the scope.
+	SPVC_ASSERT(callback_allocations == callback_frees);
+}
+
 int main()
 {
 	propagate_stack_to_heap();
@@ -221,6 +321,11 @@ int main()
 
 	convert_to_std_vector();
 
+	trivial_growth();
+	trivial_insert_middle();
+	trivial_resize_uninitialized();
+	trivial_growth_with_callbacks();
+
 	SPVC_ASSERT(allocations > 0 && deallocations > 0 && deallocations == allocations);
 }
 